@@ -0,0 +1,109 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef AS_BITSET_H
+#define AS_BITSET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/** Dense set of AS indices, one bit per AS.
+ *
+ *  Holds the inverse results of one prefix-origin: bit i is set while the
+ *  i-th non-stub AS of the graph has not received the prefix-origin. The set
+ *  starts full, which is a fill of its words, and shrinks by clearing single
+ *  bits as announcements are accepted. Iteration only visits set bits, one
+ *  count-trailing-zeros step each.
+ *
+ *  Words are updated atomically, so ASes processed in parallel may flip
+ *  their bits in the same word. Reading the set is only meaningful once
+ *  propagation has finished.
+ */
+class ASBitset {
+public:
+    /** Create a set holding every index below size.
+     *
+     * @param size Number of indices, usually the number of non-stub ASes
+     */
+    explicit ASBitset(size_t size) : words(new std::atomic<uint64_t>[(size + 63) / 64]), 
+                                     num_words((size + 63) / 64), num_bits(size) {
+        for (size_t i = 0; i < num_words; i++)
+            words[i].store(~0ULL, std::memory_order_relaxed);
+        // Keep the bits past the end clear so count() and for_each() stay exact
+        if (num_bits % 64 != 0)
+            words[num_words - 1].store((1ULL << (num_bits % 64)) - 1, std::memory_order_relaxed);
+    }
+
+    size_t size() const { return num_bits; }
+
+    bool test(uint32_t index) const {
+        return index < num_bits && (words[index >> 6].load(std::memory_order_relaxed) >> (index & 63)) & 1;
+    }
+
+    void set(uint32_t index) {
+        if (index < num_bits)
+            words[index >> 6].fetch_or(1ULL << (index & 63), std::memory_order_relaxed);
+    }
+
+    /** Remove an index. Indices outside the set, such as those of stubs,
+     *  are ignored like erasing a missing element from a std::set.
+     */
+    void reset(uint32_t index) {
+        if (index < num_bits)
+            words[index >> 6].fetch_and(~(1ULL << (index & 63)), std::memory_order_relaxed);
+    }
+
+    /** Remove every index.
+     */
+    void clear() {
+        for (size_t i = 0; i < num_words; i++)
+            words[i].store(0, std::memory_order_relaxed);
+    }
+
+    /** Number of indices in the set.
+     */
+    size_t count() const {
+        size_t total = 0;
+        for (size_t i = 0; i < num_words; i++)
+            total += __builtin_popcountll(words[i].load(std::memory_order_relaxed));
+        return total;
+    }
+
+    /** Call f with every index in the set, in increasing order.
+     */
+    template <class Function>
+    void for_each(Function f) const {
+        for (size_t i = 0; i < num_words; i++) {
+            for (uint64_t word = words[i].load(std::memory_order_relaxed); word != 0; word &= word - 1)
+                f(static_cast<uint32_t>(i * 64 + __builtin_ctzll(word)));
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+    size_t num_words;
+    size_t num_bits;
+};
+#endif
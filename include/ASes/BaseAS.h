@@ -29,6 +29,7 @@
 #define AS_REL_CUSTOMER 200
 
 #include <type_traits>
+#include <cstdint>
 #include <string>
 #include <set>
 #include <map>
@@ -36,8 +37,10 @@
 #include <random>
 #include <iostream>
 
+#include "ASBitset.h"
 #include "Logger.h"
 #include "Prefix.h"
+#include "ASes/RIB.h"
 
 #include "Announcements/Announcement.h"
 #include "Announcements/EZAnnouncement.h"
@@ -56,25 +59,27 @@ public:
     // Random Number Generator
     std::minstd_rand ran_bool;
     // Defer processing of incoming announcements for efficiency
-    std::vector<AnnouncementType> *incoming_announcements;
-    // Maps of all announcements stored
-    std::map<Prefix<>, AnnouncementType> *all_anns;
-    std::map<Prefix<>, AnnouncementType> *depref_anns;
+    std::vector<AnnouncementType, ArenaAllocator<AnnouncementType>> *incoming_announcements;
+    // Tables of all announcements stored, with the depref route next to the best one if enabled
+    RIB<AnnouncementType> *all_anns;
     // Stores AS Relationships
     std::set<uint32_t> *providers; 
     std::set<uint32_t> *peers; 
     std::set<uint32_t> *customers; 
-    // Pointer to inverted results map for efficiency
-    std::map<std::pair<Prefix<>, uint32_t>,std::set<uint32_t>*> *inverse_results; 
+    // Pointer to inverted results map for efficiency, keyed on (prefix id, origin)
+    // Each bitset is indexed by non_stub_index
+    std::map<std::pair<uint32_t, uint32_t>, ASBitset*> *inverse_results; 
     // If this AS represents multiple ASes, it's "members" are listed here (Supernodes)
     std::vector<uint32_t> *member_ases;
-    // Assigned and used in Tarjan's algorithm
-    int index;
-    int lowlink;
-    bool onStack;
+    // Dense id of this AS in its graph, indexes ases_by_id and the adjacency arrays
+    uint32_t id;
+    // Position of this AS in the graph's non_stubs, its bit in the inverse results
+    uint32_t non_stub_index;
+    // False when the relationship sets belong to the AS this one shares its topology with
+    bool owns_topology;
     
     // Constructor. Must be in header file.... We like C++ class templates. We like C++ class templates....
-    BaseAS(uint32_t asn, bool store_depref_results, std::map<std::pair<Prefix<>, uint32_t>, std::set<uint32_t>*> *inverse_results) : ran_bool(asn) {
+    BaseAS(uint32_t asn, bool store_depref_results, std::map<std::pair<uint32_t, uint32_t>, ASBitset*> *inverse_results) : ran_bool(asn) {
 
         // Set ASN
         this->asn = asn;
@@ -88,17 +93,14 @@ public:
 
         this->inverse_results = inverse_results;    // Inverted results map
         member_ases = new std::vector<uint32_t>();    // Supernode members
-        incoming_announcements = new std::vector<AnnouncementType>();
-        all_anns = new std::map<Prefix<>, AnnouncementType>();
-
-        if(store_depref_results)
-            depref_anns = new std::map<Prefix<>, AnnouncementType>();
-        else
-            depref_anns = NULL;
-
-        // Tarjan variables
-        index = -1;
-        onStack = false;
+        incoming_announcements = new std::vector<AnnouncementType, ArenaAllocator<AnnouncementType>>();
+        all_anns = new RIB<AnnouncementType>(store_depref_results);
+
+        // Assigned when the graph builds its adjacency arrays
+        id = UINT32_MAX;
+        // Assigned once the graph knows its non-stubs
+        non_stub_index = UINT32_MAX;
+        owns_topology = true;
     }
 
     BaseAS(uint32_t asn, bool store_depref_results) : BaseAS(asn, store_depref_results, NULL) { }
@@ -127,15 +129,25 @@ public:
      */
     virtual void remove_neighbor(uint32_t asn, int relationship);
 
+    /** Use the relationship sets, members, rank, and ids of another AS instead
+     *  of this AS's own, keeping only the announcement state private.
+     *
+     *  The sets are not copied, so the other AS must outlive this one and its
+     *  relationships must not change while they are shared.
+     *
+     * @param other AS with the same ASN in the graph that owns the topology
+     */
+    virtual void share_topology(const BaseAS<AnnouncementType> &other);
+
     //****************** Announcement Handling ******************//
 
     /** Swap a pair of prefix/origins for this AS in the inverse results.
      *
-     * @param old The prefix/origin to be inserted
-     * @param current The prefix/origin to be removed
+     * @param old The prefix id/origin to be inserted
+     * @param current The prefix id/origin to be removed
      */
-    virtual void swap_inverse_result(std::pair<Prefix<>,uint32_t> old, 
-                                        std::pair<Prefix<>,uint32_t> current);
+    virtual void swap_inverse_result(std::pair<uint32_t, uint32_t> old, 
+                                        std::pair<uint32_t, uint32_t> current);
 
     /** Push the incoming propagated announcements to the incoming_announcements vector.
      *
@@ -162,6 +174,13 @@ public:
     */
     virtual void clear_announcements();
 
+    /** Draw announcement storage from an arena from now on. Must be called
+     *  while the AS holds no announcements.
+     *
+     * @param arena Arena to allocate from, NULL for the heap
+     */
+    virtual void use_arena(Arena *arena);
+
     /** Check if a monitor announcement is already recv'd by this AS. 
      *
      * @param ann Announcement to check for. 
@@ -174,8 +193,10 @@ public:
     virtual void delete_ann(AnnouncementType &ann);
 
     /** Deletes the announcement of given prefix.
+     *
+     * @param prefix_id The id of the prefix in the PrefixTable
     */
-    virtual void delete_ann(Prefix<> &prefix);
+    virtual void delete_ann(uint32_t prefix_id);
 
     //****************** FILE I/O ******************//
 
@@ -195,6 +216,15 @@ public:
      */
     virtual std::ostream& stream_announcements(std::ostream &os);
 
+    /** Streams announcements and depref announcements to two output streams
+     *  in a .csv readable file format, in a single pass over the RIB.
+     *
+     * @param os
+     * @param depref_os
+     * @return output stream into which is passed the .csv row formatted announcements
+     */
+    virtual std::ostream& stream_announcements(std::ostream &os, std::ostream &depref_os);
+
     /** Streams depref announcements to an output stream in a .csv readable file format.
      *
      * @param os
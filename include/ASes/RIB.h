@@ -0,0 +1,292 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef RIB_H
+#define RIB_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <utility>
+
+#include "Arena.h"
+#include "Prefix.h"
+#include "PrefixTable.h"
+
+/** Flat routing table holding at most one announcement per prefix.
+ *
+ *  Entries are kept contiguously in a vector and located through an open
+ *  addressing index (linear probing) over the prefix id, so lookups do not
+ *  chase tree nodes and inserts do not allocate once the table has grown to
+ *  the size of a block. clear() keeps both arrays and only zeroes the index,
+ *  so a table is allocated once and reused for every block.
+ *
+ *  A table given an Arena draws both arrays from it instead. clear() then
+ *  drops the arrays without freeing them, and the memory comes back when the
+ *  owner of the arena resets it at the end of the block.
+ *
+ *  Entries are keyed on the id the PrefixTable assigned to the prefix. For
+ *  convenience find() and erase() also accept the prefix itself and resolve
+ *  it through the table.
+ *
+ *  The interface mirrors the subset of std::map used on the RIBs: find(),
+ *  insert(), erase(), size() and iteration over (prefix id, announcement)
+ *  pairs. Iteration follows insertion order rather than prefix order, and
+ *  erasing moves the last entry into the erased position.
+ *
+ *  A table built with depref storage also keeps the second best announcement
+ *  for each prefix in an array parallel to the entries. It is found by the
+ *  same lookup as the best route and moves along with it, so tracking the
+ *  depref route costs no extra probe. An empty depref slot holds an
+ *  announcement whose prefix id is PrefixTable::NO_PREFIX.
+ */
+template <class AnnouncementType>
+class RIB {
+public:
+    typedef std::pair<uint32_t, AnnouncementType> value_type;
+    typedef std::vector<value_type, ArenaAllocator<value_type>> entry_vector;
+    typedef typename entry_vector::iterator iterator;
+    typedef typename entry_vector::const_iterator const_iterator;
+
+    explicit RIB(bool store_depref = false) : num_slots(0), slot_bits(0), store_depref(store_depref) { }
+
+    /** Draw storage from an arena from now on. The table must be empty.
+     *
+     * @param arena Arena to allocate from, NULL for the heap
+     */
+    void use_arena(Arena *arena) {
+        entry_vector(ArenaAllocator<value_type>(arena)).swap(entries);
+        depref_vector(ArenaAllocator<AnnouncementType>(arena)).swap(deprefs);
+        std::vector<uint32_t, ArenaAllocator<uint32_t>>(ArenaAllocator<uint32_t>(arena)).swap(index);
+        num_slots = 0;
+        slot_bits = 0;
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    /** Whether entries carry a depref (second best) slot.
+     */
+    bool stores_depref() const { return store_depref; }
+
+    /** The second best announcement stored next to an entry.
+     *
+     * @param it Iterator to an entry of a table storing depref routes
+     * @return The depref announcement, or NULL if there is none
+     */
+    AnnouncementType* depref(const_iterator it) {
+        AnnouncementType &slot = deprefs[it - entries.cbegin()];
+        return (slot.prefix_id == PrefixTable::NO_PREFIX) ? NULL : &slot;
+    }
+
+    const AnnouncementType* depref(const_iterator it) const {
+        const AnnouncementType &slot = deprefs[it - entries.cbegin()];
+        return (slot.prefix_id == PrefixTable::NO_PREFIX) ? NULL : &slot;
+    }
+
+    /** Store the second best announcement for an entry.
+     *
+     * @param it Iterator to an entry of a table storing depref routes
+     * @param ann The announcement to keep as depref route
+     */
+    void set_depref(const_iterator it, const AnnouncementType &ann) {
+        deprefs[it - entries.cbegin()] = ann;
+    }
+
+    /** Look up the announcement for a prefix.
+     *
+     * @param prefix_id The id of the prefix to search for
+     * @return Iterator to the entry, or end() if the prefix is not present
+     */
+    iterator find(uint32_t prefix_id) {
+        if (entries.empty()) {
+            return entries.end();
+        }
+        size_t slot = find_slot(prefix_id);
+        if (index[slot] == 0) {
+            return entries.end();
+        }
+        return entries.begin() + (index[slot] - 1);
+    }
+
+    template <typename Integer>
+    iterator find(const Prefix<Integer> &prefix) {
+        uint32_t prefix_id = PrefixTable::getInstance().lookup(prefix);
+        if (prefix_id == PrefixTable::NO_PREFIX) {
+            return entries.end();
+        }
+        return find(prefix_id);
+    }
+
+    /** Insert an entry unless its prefix is already present.
+     *
+     * @param entry The (prefix id, announcement) pair to insert
+     * @return Iterator to the entry for the prefix and whether it was inserted
+     */
+    std::pair<iterator, bool> insert(const value_type &entry) {
+        // Keep the load factor at or below 3/4
+        if ((entries.size() + 1) * 4 > num_slots * 3) {
+            grow();
+        }
+        size_t slot = find_slot(entry.first);
+        if (index[slot] != 0) {
+            return std::make_pair(entries.begin() + (index[slot] - 1), false);
+        }
+        entries.push_back(entry);
+        if (store_depref) {
+            deprefs.push_back(entry.second);
+            deprefs.back().prefix_id = PrefixTable::NO_PREFIX;
+        }
+        index[slot] = entries.size();
+        return std::make_pair(entries.end() - 1, true);
+    }
+
+    /** Remove the entry for a prefix.
+     *
+     * @param prefix_id The id of the prefix to remove
+     * @return The number of entries removed (0 or 1)
+     */
+    size_t erase(uint32_t prefix_id) {
+        iterator it = find(prefix_id);
+        if (it == entries.end()) {
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+    template <typename Integer>
+    size_t erase(const Prefix<Integer> &prefix) {
+        iterator it = find(prefix);
+        if (it == entries.end()) {
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+    /** Remove the entry at a position. The last entry is moved into its place.
+     *
+     * @param it Iterator to the entry to remove
+     * @return Iterator to the entry now occupying the position (the next entry to visit)
+     */
+    iterator erase(iterator it) {
+        size_t pos = it - entries.begin();
+        size_t last = entries.size() - 1;
+
+        // Release the slot of the erased entry, then point the last entry's slot at pos
+        remove_slot(find_slot(it->first));
+        if (pos != last) {
+            index[find_slot(entries[last].first)] = pos + 1;
+            entries[pos] = std::move(entries[last]);
+            if (store_depref) {
+                deprefs[pos] = std::move(deprefs[last]);
+            }
+        }
+        entries.pop_back();
+        if (store_depref) {
+            deprefs.pop_back();
+        }
+        return entries.begin() + pos;
+    }
+
+    /** Drop all entries. Capacity is kept for reuse by the next block, unless
+     *  the storage comes from an arena, which is reclaimed when it is reset.
+     */
+    void clear() {
+        if (entries.get_allocator().arena != NULL) {
+            use_arena(entries.get_allocator().arena);
+            return;
+        }
+        if (entries.empty()) {
+            return;
+        }
+        entries.clear();
+        deprefs.clear();
+        std::memset(index.data(), 0, num_slots * sizeof(uint32_t));
+    }
+
+private:
+    typedef std::vector<AnnouncementType, ArenaAllocator<AnnouncementType>> depref_vector;
+
+    entry_vector entries;                               // Entries in insertion order
+    depref_vector deprefs;                              // Depref route of each entry, if stored
+    std::vector<uint32_t, ArenaAllocator<uint32_t>> index;  // Position in entries + 1 for each slot, 0 if empty
+    size_t num_slots;                   // Size of index, always zero or a power of two
+    unsigned slot_bits;                 // log2 of num_slots
+    bool store_depref;                  // Whether deprefs is kept parallel to entries
+
+    /** Home slot of a prefix id. Ids are dense, so Fibonacci hashing (taking
+     *  the top bits of the product) is enough to spread runs of them out.
+     */
+    size_t home(uint32_t prefix_id) const {
+        return static_cast<size_t>((prefix_id * 0x9E3779B97F4A7C15ULL) >> (64 - slot_bits));
+    }
+
+    /** Probe for the slot holding a prefix, or the empty slot where it belongs.
+     */
+    size_t find_slot(uint32_t prefix_id) const {
+        size_t mask = num_slots - 1;
+        size_t slot = home(prefix_id);
+        while (index[slot] != 0 && entries[index[slot] - 1].first != prefix_id) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    /** Empty a slot, shifting later entries of the probe chain back into the gap.
+     */
+    void remove_slot(size_t hole) {
+        size_t mask = num_slots - 1;
+        size_t slot = hole;
+        while (true) {
+            slot = (slot + 1) & mask;
+            if (index[slot] == 0) {
+                break;
+            }
+            size_t home_slot = home(entries[index[slot] - 1].first);
+            // Move the entry back if its home does not lie cyclically in (hole, slot]
+            if (((slot - home_slot) & mask) >= ((slot - hole) & mask)) {
+                index[hole] = index[slot];
+                hole = slot;
+            }
+        }
+        index[hole] = 0;
+    }
+
+    /** Double the index and reinsert every entry.
+     */
+    void grow() {
+        slot_bits = (num_slots == 0) ? 4 : slot_bits + 1;
+        num_slots = static_cast<size_t>(1) << slot_bits;
+        index.assign(num_slots, 0);
+        for (size_t i = 0; i < entries.size(); i++) {
+            index[find_slot(entries[i].first)] = i + 1;
+        }
+    }
+};
+#endif
@@ -69,7 +69,7 @@ public:
     std::vector<ROVppAnnouncement> *withdrawals;
 
     // Maps of all announcements stored
-    std::map<Prefix<>, ROVppAnnouncement> *loc_rib;
+    RIB<ROVppAnnouncement> *loc_rib;
 
     std::vector<uint32_t> policy_vector;
     std::set<uint32_t> *attackers;
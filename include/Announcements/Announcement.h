@@ -27,19 +27,27 @@
 #include <cstdint>
 #include <iostream>
 #include <vector>
+#include <type_traits>
 
 #include "Prefix.h"
+#include "PrefixTable.h"
 
+/** Announcement as stored in the RIBs and copied between ASes.
+ *
+ *  This is a plain, trivially copyable record with no virtual functions, so
+ *  the vanilla extrapolator moves 20 bytes per copy. The prefix is held as
+ *  its id in the PrefixTable. Priority keeps its decimal encoding
+ *  (relationship class in the hundreds, path length weight below) in a
+ *  15-bit field and shares its 16 bits with the seeded flag.
+ */
 class Announcement {
 public:
-    Prefix<> prefix;            // encoded with subnet mask
-    uint32_t origin;            // origin ASN
-    uint32_t priority;          // priority assigned based upon path
-    uint32_t received_from_asn; // ASN that sent the ann
-    bool from_monitor = false;  // flag for seeded ann
-    int64_t tstamp;             // timestamp from mrt file
-    // TODO replace with proper templating
-    uint32_t policy_index;      // stores the policy index the ann applies
+    uint32_t prefix_id;             // id of the prefix in the PrefixTable
+    uint32_t origin;                // origin ASN
+    uint32_t received_from_asn;     // ASN that sent the ann
+    uint32_t tstamp;                // timestamp from mrt file (32-bit seconds in the MRT header)
+    uint16_t priority : 15;         // priority assigned based upon path
+    uint16_t from_monitor : 1;      // flag for seeded ann
 
     /** Default constructor
      */
@@ -51,9 +59,20 @@ public:
     Announcement(uint32_t aorigin, uint32_t aprefix, uint32_t anetmask,
         uint32_t pr, uint32_t from_asn, int64_t timestamp, bool a_from_monitor = false);
 
-    /** Copy constructor
+    /** Priority constructor for IPv6 prefixes
+     */
+    Announcement(uint32_t aorigin, const Prefix<unsigned __int128> &aprefix,
+        uint32_t pr, uint32_t from_asn, int64_t timestamp, bool a_from_monitor = false);
+
+    /** Resolve the prefix through the PrefixTable.
+     *
+     * Only meaningful for IPv4 announcements, see PrefixTable::prefix6.
+     *
+     * @return The prefix this announcement is for
      */
-    Announcement(const Announcement& ann);
+    const Prefix<>& prefix() const {
+        return PrefixTable::getInstance().prefix(prefix_id);
+    }
 
     //****************** FILE I/O ******************//
 
@@ -66,12 +85,19 @@ public:
      * @return The output stream parameter for reuse/recursion.
      */ 
     friend std::ostream& operator<<(std::ostream &os, const Announcement& ann);
-
-    /** Passes the announcement struct data to an output stream to csv generation.
-     *
-     * @param &os Specifies the output stream.
-     * @return The output stream parameter for reuse/recursion.
-     */ 
-    virtual std::ostream& to_csv(std::ostream &os);
 };
+
+static_assert(std::is_trivially_copyable<Announcement>::value, "Announcement must stay trivially copyable");
+static_assert(sizeof(Announcement) <= 20, "Announcement must stay packed");
+
+/** Passes the announcement data to an output stream for csv generation.
+ *
+ * Derived announcement types provide their own overload, which is picked when
+ * the stored type is known at compile time.
+ *
+ * @param &os Specifies the output stream.
+ * @param ann Specifies the announcement from which data is pulled.
+ * @return The output stream parameter for reuse/recursion.
+ */ 
+std::ostream& to_csv(std::ostream &os, const Announcement &ann);
 #endif
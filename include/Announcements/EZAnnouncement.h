@@ -1,11 +1,14 @@
 #ifndef EZ_ANNOUNCEMENT_H
 #define EZ_ANNOUNCEMENT_H
 
+#include <algorithm>
+
 #include "Announcements/Announcement.h"
+#include "PathTable.h"
 
 class EZAnnouncement : public Announcement {
 public:
-    std::vector<uint32_t> as_path;
+    uint32_t path_id;           // as path in the PathTable, origin at the root
     bool from_attacker;
 
     /** Default constructor
@@ -18,9 +21,24 @@ public:
     EZAnnouncement(uint32_t aorigin, uint32_t aprefix, uint32_t anetmask,
         uint32_t pr, uint32_t from_asn, int64_t timestamp, bool a_from_monitor = false, bool from_attacker = false);
 
+    /** Priority constructor for IPv6 prefixes
+     */
+    EZAnnouncement(uint32_t aorigin, const Prefix<unsigned __int128> &aprefix,
+        uint32_t pr, uint32_t from_asn, int64_t timestamp, bool a_from_monitor = false, bool from_attacker = false);
+
     /** Copy constructor
      */
     EZAnnouncement(const EZAnnouncement& ann);
+
+    /** Materialize the as path, most recent AS first.
+     *
+     * @return The ASNs on the path
+     */
+    std::vector<uint32_t> as_path() const {
+        std::vector<uint32_t> path = PathTable::getInstance().materialize(path_id);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
 };
 
 #endif
\ No newline at end of file
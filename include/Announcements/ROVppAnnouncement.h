@@ -25,15 +25,17 @@
 #define ROV_ANNOUNCEMENT_H
 
 #include "Announcements/Announcement.h"
+#include "PathTable.h"
 
 class ROVppAnnouncement : public Announcement {
 public:
     uint32_t alt;               // flag meaning a "hole" along the path
     uint32_t tiebreak_override; // ensure tiebreaks propagate where they should
     uint32_t sent_to_asn;       // ASN this ann is being sent to
+    uint32_t policy_index;      // stores the policy index the ann applies
 
     bool withdraw;              // if this is a withdrawn route
-    std::vector<uint32_t> as_path; // stores full as path
+    uint32_t path_id;           // full as path, origin first, in the PathTable
 
     /** Default constructor
      */
@@ -68,6 +70,14 @@ public:
      */
     ROVppAnnouncement(const ROVppAnnouncement& ann);
 
+    /** Materialize the full as path, origin first.
+     *
+     * @return The ASNs on the path
+     */
+    std::vector<uint32_t> as_path() const {
+        return PathTable::getInstance().materialize(path_id);
+    }
+
     /** Copy assignment
      */
     ROVppAnnouncement& operator=(ROVppAnnouncement ann);
@@ -86,23 +96,25 @@ public:
      */ 
     friend std::ostream& operator<<(std::ostream &os, const ROVppAnnouncement& ann);
 
-    /** Passes the announcement struct data to an output stream to csv generation.
-     *
-     * @param &os Specifies the output stream.
-     * @return The output stream parameter for reuse/recursion.
-     */ 
-    virtual std::ostream& to_csv(std::ostream &os);
-
-    /** Passes the announcement struct data to an output stream to csv generation.
-     * For creating the rovpp_blackholes table only.
-     * 
-     * @param &os Specifies the output stream.
-     * @return The output stream parameter for reuse/recursion.
-     */ 
-    virtual std::ostream& to_blackholes_csv(std::ostream &os);
-    
     bool operator==(const ROVppAnnouncement &b) const;
     bool operator!=(const ROVppAnnouncement &b) const;
     bool operator<(const ROVppAnnouncement &b) const;
 };
+
+/** Passes the announcement struct data to an output stream to csv generation.
+ *
+ * @param &os Specifies the output stream.
+ * @param ann Specifies the announcement from which data is pulled.
+ * @return The output stream parameter for reuse/recursion.
+ */ 
+std::ostream& to_csv(std::ostream &os, const ROVppAnnouncement &ann);
+
+/** Passes the announcement struct data to an output stream to csv generation.
+ * For creating the rovpp_blackholes table only.
+ * 
+ * @param &os Specifies the output stream.
+ * @param ann Specifies the announcement from which data is pulled.
+ * @return The output stream parameter for reuse/recursion.
+ */ 
+std::ostream& to_blackholes_csv(std::ostream &os, const ROVppAnnouncement &ann);
 #endif
\ No newline at end of file
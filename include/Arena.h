@@ -0,0 +1,146 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+/** Monotonic arena for announcement storage that lives for one block.
+ *
+ *  Allocations are carved from large chunks by bumping an offset and are
+ *  never freed individually. reset() rewinds to the first chunk in constant
+ *  time and keeps every chunk, so the next block reuses the same memory
+ *  without touching the system allocator. Objects placed in the arena must
+ *  be destroyed or abandoned by their owners before reset().
+ *
+ *  Every thread bumps through a region of its own, a whole chunk claimed
+ *  from the shared chunk list, so propagation threads allocate without
+ *  synchronizing. The lock is only taken to claim the next region.
+ */
+class Arena {
+public:
+    /** Create an empty arena. No memory is reserved until the first allocation.
+     *
+     * @param chunk_size Minimum size of each chunk in bytes
+     */
+    explicit Arena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /** Allocate uninitialized memory that stays valid until the next reset().
+     *  Safe to call from several threads at once.
+     *
+     * @param bytes Number of bytes to allocate
+     * @param alignment Required alignment, a power of two
+     * @return Pointer to the allocated memory
+     */
+    void *allocate(size_t bytes, size_t alignment);
+
+    /** Release every allocation at once. Chunks are kept for reuse.
+     *  No other thread may allocate from the arena at the same time.
+     */
+    void reset();
+
+    /** Size of the regions claimed by threads since the last reset, which 
+     *  includes alignment padding and the unused tails of regions.
+     */
+    size_t bytes_in_use() const;
+
+    /** Largest bytes_in_use() seen since the arena was created.
+     */
+    size_t high_water_mark() const;
+
+    /** Total size of all chunks held by the arena.
+     */
+    size_t bytes_reserved() const;
+
+    static const size_t DEFAULT_CHUNK_SIZE = 4 << 20;
+
+private:
+    struct Chunk {
+        char *data;
+        size_t size;
+    };
+
+    /** Claim the next chunk with room for bytes as the calling thread's region.
+     */
+    Chunk claim_region(size_t bytes, size_t alignment);
+
+    std::vector<Chunk> chunks;  // Every chunk ever allocated, in claim order
+    size_t claimed;             // Chunks handed out as regions since the last reset
+    size_t used;                // Size of those chunks
+    size_t high_water;
+    size_t reserved;
+    size_t chunk_size;
+    const uint64_t id;                  // Unique over the process, unlike the address
+    std::atomic<uint64_t> generation;   // Bumped by reset to retire every region
+    mutable std::mutex lock;
+};
+
+/** Standard allocator that draws from an Arena, or from the heap when no
+ *  arena is given. Deallocation is a no-op for arena memory.
+ */
+template <class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    // Containers hand their arena over along with their storage
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    Arena *arena;
+
+    ArenaAllocator(Arena *arena = NULL) : arena(arena) { }
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) { }
+
+    T *allocate(size_t n) {
+        if (arena == NULL)
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t) {
+        if (arena == NULL)
+            ::operator delete(p);
+    }
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+#endif
@@ -151,6 +151,17 @@ public:
      */
     virtual std::vector<uint32_t>* parse_path(std::string path_as_string); 
 
+    /** Parse an array-like string such as "{1,2,3}" into a reusable buffer.
+     *
+     * Digits are scanned straight from the bytes of the field, so seeding a row
+     * neither copies the string nor allocates once the buffer has grown to the
+     * longest path. Malformed ASNs are logged and skipped.
+     *
+     * @param path_as_string the as_path as a null-terminated string from libpqxx
+     * @param as_path Buffer that is cleared and then filled with the AS path
+     */
+    virtual void parse_path(const char *path_as_string, std::vector<uint32_t> &as_path);
+
     /** Check for loops in the path and drop announcement if they exist
     */
     virtual bool find_loop(std::vector<uint32_t>* as_path);
@@ -168,20 +179,49 @@ public:
      *
      * This approximates the Adj-RIBs-out. 
      *
-     * @param asn AS that is sending out announces
+     * @param source_as AS that is sending out announces
      * @param to_providers Send to providers
      * @param to_peers Send to peers
      * @param to_customers Send to customers
      */
-    virtual void send_all_announcements(uint32_t asn, 
+    virtual void send_all_announcements(ASType *source_as, 
                                         bool to_providers = false, 
                                         bool to_peers = false, 
                                         bool to_customers = false) = 0;
 
+    /** Send all announcements kept by an AS to its neighbors, looking the AS up by ASN. 
+     *
+     * @param asn AS that is sending out announces
+     * @param to_providers Send to providers
+     * @param to_peers Send to peers
+     * @param to_customers Send to customers
+     */
+    void send_all_announcements(uint32_t asn, 
+                                bool to_providers = false, 
+                                bool to_peers = false, 
+                                bool to_customers = false);
+
     /** Save the results of a single iteration to a in-memory
+     *
+     *  Runs write_results and then copy_results.
      *
      * @param iteration The current iteration of the propagation
      */
     virtual void save_results(int iteration);
+
+    /** Write the results held by the graph to the in-memory files of an iteration.
+     *
+     *  This is the part of saving that reads the graph, it is done once
+     *  this returns.
+     *
+     * @param iteration The current iteration of the propagation
+     */
+    virtual void write_results(int iteration);
+
+    /** Copy the files written by write_results to the database and remove them.
+     *
+     * @param iteration The iteration whose files to copy
+     */
+    virtual void copy_results(int iteration);
 };
 #endif
@@ -4,6 +4,27 @@
 #define DEFAULT_ITERATION_SIZE 50000
 
 #include "Extrapolators/BaseExtrapolator.h"
+#include "BoundedQueue.h"
+#include "ThreadPool.h"
+
+/** An announcement selected from the database and parsed, ready to be seeded.
+ */
+template <typename Integer>
+struct SeedAnnouncement {
+    uint32_t origin;
+    Prefix<Integer> prefix;
+    std::vector<uint32_t> as_path;
+    int64_t timestamp;
+};
+
+/** The announcements of one block, as handed from fetching to propagation.
+ */
+template <typename Integer>
+struct FetchedBlock {
+    Prefix<Integer> *prefix;    // Prefix or subnet the block was selected by
+    uint32_t size;              // Announcements selected, including those dropped for loops
+    std::vector<SeedAnnouncement<Integer>> announcements;
+};
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 class BlockedExtrapolator : public BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>  {
@@ -16,19 +37,200 @@ protected:
      */
     virtual void init();
 
+    /**
+     *  Overrwritable function that is called by init to generate the graph
+     *  and populate the stubs & supernode tables. Throws std::runtime_error when
+     *  the relationships cannot be read, which stops the run before any results
+     *  table is cleared.
+     */
+    virtual void build_graph();
+
     /**
      *  Overrwritable function that is called after populate_blocks in the preform_propagation function.
      *  Purely here for inheritance reasons.
      */
-    virtual void extrapolate(std::vector<Prefix<>*> *prefix_blocks, std::vector<Prefix<>*> *subnet_blocks);
+    virtual void extrapolate(std::vector<Prefix<>*> *prefix_blocks, 
+                                std::vector<Prefix<>*> *subnet_blocks,
+                                std::vector<Prefix<unsigned __int128>*> *prefix_blocks6 = NULL,
+                                std::vector<Prefix<unsigned __int128>*> *subnet_blocks6 = NULL);
+
+    /** Shared body of populate_blocks for both address families.
+     */
+    template <typename Integer>
+    void populate_family_blocks(Prefix<Integer>*, 
+                                std::vector<Prefix<Integer>*>*, 
+                                std::vector<Prefix<Integer>*>*);
+
+    /** Shared body of extrapolate_blocks for both address families.
+     */
+    template <typename Integer>
+    void extrapolate_family_blocks(uint32_t &announcement_count, 
+                                    int &iteration, 
+                                    bool subnet, 
+                                    std::vector<Prefix<Integer>*> *prefix_set);
+
+    /** Select, seed, propagate, and save one block of announcements, then
+     *  clear the graph for the next one.
+     *
+     * @param prefix The prefix or subnet of the block
+     * @param subnet Select the whole subnet instead of the prefix alone
+     * @param iteration Number of the block, names its result files
+     * @return Number of announcements in the block, 0 if it was empty
+     */
+    template <typename Integer>
+    uint32_t extrapolate_block(Prefix<Integer> *prefix, bool subnet, int iteration);
+
+    /** Select the announcements of a block and parse them. Paths with loops
+     *  are logged and dropped. Only reads the database, never the graph.
+     *
+     * @param prefix The prefix or subnet of the block
+     * @param subnet Select the whole subnet instead of the prefix alone
+     * @param block Filled with the parsed announcements
+     * @param db_lock Held while querying, NULL if the querier is not shared
+     */
+    template <typename Integer>
+    void fetch_block(Prefix<Integer> *prefix, bool subnet, FetchedBlock<Integer> &block, std::mutex *db_lock = NULL);
+
+    /** Seed and propagate a fetched block, write its results with 
+     *  write_results, and clear the graph for the next one.
+     *
+     * @param block The parsed announcements
+     * @param iteration Number of the block, names its result files
+     */
+    template <typename Integer>
+    void propagate_block(FetchedBlock<Integer> &block, int iteration);
+
+    /** Extrapolate a set of blocks in three stages running at once: the next
+     *  blocks are fetched and parsed while one propagates and the results 
+     *  of the previous ones are copied to the database. 
+     *
+     *  At most pipeline_depth blocks wait between two stages, which bounds 
+     *  the memory held by fetched blocks and unsaved result files.
+     */
+    template <typename Integer>
+    void pipeline_blocks(uint32_t &announcement_count, 
+                            int &iteration, 
+                            bool subnet, 
+                            std::vector<Prefix<Integer>*> *prefix_set);
+
+    /** Make sure block_workers workers exist.
+     *
+     * @return false if create_worker does not support them
+     */
+    bool start_workers();
+
+    /** Delete the block workers and their announcement storage.
+     */
+    void stop_workers();
+
+    /** Seed copies of an announcement on all ASes on as_path.
+     *
+     * @param as_path Vector of ASNs for this announcement.
+     * @param seeded_ann The announcement as held by the origin, priority and sender are filled per hop.
+     * @param timestamp The timestamp of the announcement.
+     */
+    void seed_as_path(std::vector<uint32_t>* as_path, const AnnouncementType &seeded_ann, int64_t timestamp);
+
+    /** Process at an AS the announcements held by a row of its neighbors.
+     *
+     *  Reads each neighbor's Loc-RIB in place and hands every announcement 
+     *  to process_announcement with the priority it would have been sent with,
+     *  so nothing is copied into incoming_announcements unless deferred.
+     *
+     * @param as The receiving AS
+     * @param neighbors Adjacency row of the neighbors to read from, in propagation order
+     * @param relationship AS_REL_PROVIDER, AS_REL_PEER, or AS_REL_CUSTOMER, the neighbors as seen by the receiver
+     * @param defer Queue the announcements on incoming_announcements instead of processing them
+     */
+    virtual void pull_announcements(ASType *as, CSRAdjacency::Row neighbors, uint32_t relationship, bool defer = false);
+
+    /** Run f on every AS of a rank, spread over the propagation threads.
+     *
+     *  Returns once all of them are done, which is the barrier between ranks.
+     *  When the neighbors each AS reads from are given, the rank is split by
+     *  the announcements they hold, so a tier-1 AS with a large fan-out does 
+     *  not share its chunk with many others. Idle threads steal chunks from
+     *  busy ones either way.
+     *
+     * @param rank Ids of the ASes in the rank
+     * @param f Called with each AS, concurrently when threads > 1
+     * @param sources Adjacency the ASes pull from, NULL to split the rank evenly
+     */
+    template <typename Function>
+    void for_each_in_rank(const std::vector<uint32_t> &rank, Function f, const CSRAdjacency *sources = NULL);
+
+    /** Pull from customers and then peers, visiting only ASes on the frontier.
+     *
+     *  Seeded ASes start the frontier. An AS holding announcements after its
+     *  visit queues its providers, which sit in higher ranks, so every rank
+     *  is final when it is reached. The peer pass then visits the peers of
+     *  ASes holding announcements, in rank order.
+     */
+    void propagate_up_sparse();
+
+    /** Pull from providers, visiting only the customers of ASes holding announcements.
+     */
+    void propagate_down_sparse();
+
+    /** Size the frontier structures for the graph, they are kept between blocks.
+     */
+    void prepare_frontier();
+
+    /** Queue an AS for the current pass in the list of its rank, once.
+     *
+     * @param id Id of the AS
+     */
+    void enqueue(uint32_t id);
+
+    /** Take the queued ASes of a rank, in the order they were queued.
+     *
+     * @param level The rank
+     * @param rank Filled with the ids of the queued ASes
+     */
+    void take_frontier(size_t level, std::vector<uint32_t> &rank);
+
+    /** Remember every visited AS holding announcements, and queue its 
+     *  neighbors in a row for the current pass.
+     *
+     * @param rank Ids of the ASes just visited
+     * @param next Adjacency of the neighbors to queue
+     */
+    void advance_frontier(const std::vector<uint32_t> &rank, const CSRAdjacency *next);
+
+    ThreadPool *pool;           // Workers for rank-parallel propagation, created on first use
+    ASBitset *queued;           // AS ids on the frontier of the current pass
+    std::vector<std::vector<uint32_t>> *frontier;   // Queued AS ids by rank
+    ASBitset *touched_bits;     // AS ids in touched
+    std::vector<uint32_t> *touched; // ASes seeded or visited in this block, the only ones holding announcements
+    std::vector<BlockedExtrapolator*> *workers; // Extrapolators each working on a block at a time
 
 public:
+    std::string as_rel_file;    // CAIDA as-rel file to build the graph from, empty to use the database
+    bool pull_propagation;      // Receivers read their neighbors' Loc-RIBs instead of being sent copies
+    bool ipv6;                  // Also extrapolate IPv6 announcements, after the IPv4 blocks
+    uint32_t threads;           // Threads propagating the ASes of a rank in parallel, needs pull_propagation
+    uint32_t block_workers;     // Blocks extrapolated at the same time, each by a worker with its own RIBs
+    uint32_t pipeline_depth;    // Blocks queued between fetching, propagation, and saving, 0 runs them in turn
+    bool sparse_propagation;    // Only visit ASes reached by the block, needs pull_propagation and seeding through seed_as_path
+
     BlockedExtrapolator(bool random_tiebraking,
                         bool store_invert_results, 
                         bool store_depref_results,
                         uint32_t iteration_size) : BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>(random_tiebraking, store_invert_results, store_depref_results) {
         
         this->iteration_size = iteration_size;
+        pull_propagation = true;
+        ipv6 = false;
+        threads = 1;
+        block_workers = 1;
+        pipeline_depth = 0;
+        sparse_propagation = false;
+        pool = NULL;
+        workers = NULL;
+        queued = NULL;
+        frontier = NULL;
+        touched_bits = NULL;
+        touched = NULL;
     }
 
     BlockedExtrapolator() : BlockedExtrapolator(DEFAULT_RANDOM_TIEBRAKING, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, DEFAULT_ITERATION_SIZE) { }
@@ -51,12 +253,51 @@ public:
                                     std::vector<Prefix<>*>*, 
                                     std::vector<Prefix<>*>*);
 
+    /** Break the IPv6 announcements into blocks, starting from ::/0.
+     */
+    virtual void populate_blocks(Prefix<unsigned __int128>*, 
+                                    std::vector<Prefix<unsigned __int128>*>*, 
+                                    std::vector<Prefix<unsigned __int128>*>*);
+
     /** Process a set of prefix or subnet blocks in iterations.
+     *
+     *  With block_workers above one, the workers take the next unprocessed 
+     *  block whenever they finish one, so blocks run concurrently. Each block
+     *  keeps the iteration number it would have had when run in order.
+     *  Otherwise, with pipeline_depth above zero, database work overlaps 
+     *  propagation as in pipeline_blocks.
     */
     virtual void extrapolate_blocks(uint32_t &announcement_count, 
                                     int &iteration, 
                                     bool subnet, 
                                     std::vector<Prefix<>*> *prefix_set);
+    virtual void extrapolate_blocks(uint32_t &announcement_count, 
+                                    int &iteration, 
+                                    bool subnet, 
+                                    std::vector<Prefix<unsigned __int128>*> *prefix_set);
+
+    /** Record that an AS may hold announcements of the current block.
+     *
+     *  Seeding through seed_as_path does this already. Anything placing 
+     *  announcements at an AS directly must call it when sparse_propagation 
+     *  is set, which otherwise does nothing.
+     *
+     * @param as The AS
+     */
+    void touch(ASType *as);
+
+    /** Clear the announcements of the current block from the graph, only 
+     *  at the touched ASes with sparse_propagation.
+     */
+    void clear_block();
+
+    /** Create an extrapolator to work on blocks alongside this one.
+     *
+     *  The worker holds its own querier and a graph sharing this graph's 
+     *  topology, see BaseGraph::share_topology. Returns NULL when blocks
+     *  cannot be extrapolated concurrently, which is the default.
+     */
+    virtual BlockedExtrapolator *create_worker();
 
     /** Seed announcement on all ASes on as_path. 
      *
@@ -69,17 +310,45 @@ public:
      * @param prefix The prefix this announcement is for.
      */
     virtual void give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<> prefix, int64_t timestamp = 0);
+    virtual void give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<unsigned __int128> prefix, int64_t timestamp = 0);
+
+    /** Propagate announcements from customers to peers and providers ASes.
+     *
+     *  With pull_propagation set, every AS reads its customers' and then its
+     *  peers' Loc-RIBs when it is visited. Adjacency rows are kept in 
+     *  propagation order, so the results match sending the announcements.
+     *
+     *  With more than one thread the ASes of a rank pull in parallel. Each
+     *  only writes its own RIB and reads customers in lower ranks, which are
+     *  final. Peers may share a rank, so peer routes are queued by every AS
+     *  first and processed in a second pass. Only customer routes are
+     *  exported to peers and those no longer change, so the results do not
+     *  depend on the number of threads.
+     *
+     *  With sparse_propagation set as well, see propagate_up_sparse.
+     */
+    virtual void propagate_up();
+
+    /** Send "best" announces from providers to customer ASes. 
+     *
+     *  With pull_propagation set, every AS reads its providers' Loc-RIBs.
+     *  Providers sit in higher ranks, so the ASes of a rank pull in parallel
+     *  when threads is above one. With sparse_propagation set as well, see
+     *  propagate_down_sparse.
+     */
+    virtual void propagate_down();
 
     /** Send all announcements kept by an AS to its neighbors. 
      *
      * This approximates the Adj-RIBs-out. 
      *
-     * @param asn AS that is sending out announces
+     * @param source_as AS that is sending out announces
      * @param to_providers Send to providers
      * @param to_peers Send to peers
      * @param to_customers Send to customers
      */
-    virtual void send_all_announcements(uint32_t asn, bool to_providers = false, bool to_peers = false, bool to_customers = false);
+    virtual void send_all_announcements(ASType *source_as, bool to_providers = false, bool to_peers = false, bool to_customers = false);
+    using BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::send_all_announcements;
 };
 
 #endif
\ No newline at end of file
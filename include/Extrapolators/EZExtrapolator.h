@@ -101,9 +101,10 @@ public:
     /*
     * A quick overwrite that removes the traditional saving functionality since we are 
     *   only interested in the probibilities, not so much the actual info the extrapolator dumps out about the accepted announcements.
-    * Comment out the first line if the output is needed.
+    * Comment out the first line of both if the output is needed.
     */
-    void save_results(int iteration);
+    void write_results(int iteration);
+    void copy_results(int iteration);
 };
 
 #endif
\ No newline at end of file
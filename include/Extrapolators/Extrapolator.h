@@ -27,7 +27,15 @@
 #include "Extrapolators/BlockedExtrapolator.h"
 
 class Extrapolator : public BlockedExtrapolator<SQLQuerier, ASGraph, Announcement, AS> {
+protected:
+    /** Load the graph from topology_snapshot if it matches the relationship tables,
+     *  otherwise build it from the database and write a new snapshot.
+     */
+    void build_graph();
+
 public:
+    std::string topology_snapshot;  // Path of the binary topology snapshot, empty to always use the database
+
     Extrapolator(bool random_tiebraking,
                     bool store_invert_results, 
                     bool store_depref_results, 
@@ -40,6 +48,11 @@ public:
     Extrapolator();
     ~Extrapolator();
 
+    /** Create an Extrapolator with its own database connection over this
+     *  graph's topology, to extrapolate blocks alongside this one.
+     */
+    BlockedExtrapolator *create_worker();
+
 };
 
 #endif
\ No newline at end of file
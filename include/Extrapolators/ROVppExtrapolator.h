@@ -69,13 +69,13 @@ struct ROVppExtrapolator: public BaseExtrapolator<ROVppSQLQuerier, ROVppASGraph,
 
     /** Check for a loop in the AS path using traceback.
      *
-     * @param  p Prefix to check for
+     * @param  prefix_id Id of the prefix to check for
      * @param  a The ASN that, if seen, will mean we have a loop
      * @param  cur_as The current AS we are at in the traceback
      * @param  d The current depth of the search
      * @return true if a loop is detected, else false
      */
-    bool loop_check(Prefix<> p, const ROVppAS& cur_as, uint32_t a, int d); 
+    bool loop_check(uint32_t prefix_id, const ROVppAS& cur_as, uint32_t a, int d); 
 
     /** Given an announcement and index, returns priority.
     */
@@ -116,15 +116,16 @@ struct ROVppExtrapolator: public BaseExtrapolator<ROVppSQLQuerier, ROVppASGraph,
      * This approximates the Adj-RIBs-out. ROVpp version simply replaces Announcement 
      * objects with ROVppAnnouncements.
      *
-     * @param asn AS that is sending out announces
+     * @param source_as AS that is sending out announces
      * @param to_providers Send to providers
      * @param to_peers Send to peers
      * @param to_customers Send to customers
      */
-    void send_all_announcements(uint32_t asn,
+    void send_all_announcements(ROVppAS *source_as,
                                 bool to_providers = false,
                                 bool to_peers = false,
                                 bool to_customers = false);
+    using BaseExtrapolator<ROVppSQLQuerier, ROVppASGraph, ROVppAnnouncement, ROVppAS>::send_all_announcements;
 
     /** Saves the results of the extrapolation. ROVpp version uses the ROVppQuerier.
     */
@@ -34,11 +34,13 @@ class SQLQuerier;
 #include <map>
 #include <unordered_map>
 #include <vector>
-#include <stack>
 #include <sys/stat.h>
 #include <dirent.h>
 #include <pqxx/pqxx>
 
+#include "Arena.h"
+#include "Graphs/CSRAdjacency.h"
+#include "Graphs/TopologySnapshot.h"
 #include "ASes/AS.h"
 #include "ASes/EZAS.h"
 #include "ASes/ROVppAS.h"
@@ -54,29 +56,47 @@ class BaseGraph {
 
 public:
     std::unordered_map<uint32_t, ASType*> *ases;            // Map of ASN to AS object 
-    std::vector<std::set<uint32_t>*> *ases_by_rank;     // Vector of ranks
-    std::vector<std::vector<uint32_t>*> *components;    // Strongly connected components
+    std::vector<ASType*> *ases_by_id;                   // Dense AS id to AS object
+    std::vector<std::vector<uint32_t>*> *ases_by_rank;  // AS ids in each rank
+    CSRAdjacency *components;                           // Strongly connected components, one row of member ASNs each
     std::map<uint32_t, uint32_t> *component_translation;// Translate AS to supernode AS
     std::map<uint32_t, uint32_t> *stubs_to_parents;
     std::vector<uint32_t> *non_stubs;
-    std::map<std::pair<Prefix<>, uint32_t>,std::set<uint32_t>*> *inverse_results; 
+    std::map<std::pair<uint32_t, uint32_t>, ASBitset*> *inverse_results; 
+    // Read-only adjacency used during propagation, AS ids indexed by AS id.
+    // Once ranked, each row lists its neighbors in propagation order.
+    CSRAdjacency *provider_csr;
+    CSRAdjacency *peer_csr;
+    CSRAdjacency *customer_csr;
 
     bool store_depref_results;
+    uint32_t scc_threads;       // Threads for component detection, 1 uses Tarjan
+    bool rank_major_ids;        // Renumber ids by rank after decide_ranks
+    Arena *announcement_arena;  // Storage for the announcements of the current block
+    bool owns_topology;         // False for a workspace sharing another graph's ranks and adjacency
 
     BaseGraph(bool store_inverse_results, bool store_depref_results) {
         ases = new std::unordered_map<uint32_t, ASType*>;               // Map of all ASes
-        ases_by_rank = new std::vector<std::set<uint32_t>*>;        // Vector of ASes by rank
-        components = new std::vector<std::vector<uint32_t>*>;       // All Strongly connected components
+        ases_by_id = new std::vector<ASType*>;                      // All ASes by dense id
+        ases_by_rank = new std::vector<std::vector<uint32_t>*>;     // Vector of ASes by rank
+        components = new CSRAdjacency();                            // All Strongly connected components
         component_translation = new std::map<uint32_t, uint32_t>;   // Translate node to supernode
         stubs_to_parents = new std::map<uint32_t, uint32_t>;        // Translace stub to parent
         non_stubs = new std::vector<uint32_t>;                      // All non-stubs in the graph
+        provider_csr = new CSRAdjacency();                          // Flattened provider sets
+        peer_csr = new CSRAdjacency();                              // Flattened peer sets
+        customer_csr = new CSRAdjacency();                          // Flattened customer sets
 
         if(store_inverse_results) 
-            inverse_results = new std::map<std::pair<Prefix<>, uint32_t>, std::set<uint32_t>*>;
+            inverse_results = new std::map<std::pair<uint32_t, uint32_t>, ASBitset*>;
         else 
             inverse_results = NULL;
         
         this->store_depref_results = store_depref_results;
+        scc_threads = 1;
+        rank_major_ids = true;
+        announcement_arena = new Arena();
+        owns_topology = true;
     }
 
     virtual ~BaseGraph();
@@ -84,12 +104,44 @@ public:
     //Creation of template type
     virtual ASType* createNew(uint32_t asn) = 0;
 
+    /** Create an AS through createNew that keeps its announcements in announcement_arena.
+     */
+    ASType* create_as(uint32_t asn);
+
     //****************** Propagation Interaction ******************//
 
     /** Clear all announcements in AS.
-    */
+     *
+     *  The ASes drop their announcement storage and the arena it came from is
+     *  reset in one step, ready for the next block.
+     */
     virtual void clear_announcements();
 
+    /** Clear the announcements of some ASes only, then reset the arena and 
+     *  the inverse results like clear_announcements.
+     *
+     *  Every other AS must hold no announcements.
+     *
+     * @param ids Ids of the ASes that may hold announcements
+     */
+    void clear_announcements(const std::vector<uint32_t> &ids);
+
+    /** Turn this empty graph into a workspace over the topology of another.
+     *
+     *  Ranks, adjacency arrays, supernodes, stubs, and the relationship sets 
+     *  of every AS are shared with the other graph and never written through 
+     *  this one. Each AS gets a counterpart here with the same id, holding 
+     *  its own RIB in this graph's arena, so several workspaces can propagate
+     *  different prefix blocks at the same time. The inverse results stay 
+     *  private as well.
+     *
+     *  The other graph must be processed, and must outlive this one without
+     *  its topology changing.
+     *
+     * @param other Processed graph owning the topology
+     */
+    void share_topology(BaseGraph<ASType> *other);
+
     /** Translates asn to asn of component it belongs to in graph.
      *
      *  @param asn the asn to translate
@@ -109,6 +161,20 @@ public:
      */
     void add_relationship(uint32_t asn, uint32_t neighbor_asn, int relation);
 
+    /** Removes relationships from a processed graph, keeping the adjacency 
+     *  arrays and ranks up to date without reprocessing it.
+     *
+     *  Removing edges from the combined DAG cannot create or split a component,
+     *  so only ranks need maintenance. An AS that lost a customer is re-ranked,
+     *  and only ASes whose rank actually fell pass the change on to their 
+     *  providers. Moved ASes keep ASN order within their new rank and the 
+     *  adjacency rows are put back in propagation order, so propagation 
+     *  matches a full decide_ranks, but ids are no longer rank-major.
+     *
+     * @param edges Pairs of ASNs to disconnect, whatever their relationship
+     */
+    void remove_relationships(const std::vector<std::pair<uint32_t, uint32_t>> &edges);
+
     /** Process with removing stubs (needs querier to save them).
     */
     virtual void process(SQLQuerier *querier);
@@ -121,6 +187,34 @@ public:
      */
     virtual void create_graph_from_db(SQLQuerier *querier);
 
+    /** Adds every relationship in the peers and customer_providers tables to the graph.
+     *
+     *  Both tables are streamed with a binary COPY, see SQLQuerier::copy_columns_from_db.
+     *
+     * @param querier
+     * @throws std::runtime_error if either table could not be read completely
+     */
+    void add_relationships_from_db(SQLQuerier *querier);
+
+    /** Generates an ASGraph from a CAIDA as-rel file (serial-1 or serial-2) 
+     *  and processes it like create_graph_from_db.
+     *
+     * @param path Location of the as-rel file
+     * @param querier Querier to save the stubs and supernodes with, or NULL to skip saving
+     * @throws std::runtime_error if the file could not be read, before anything is saved
+     */
+    virtual void create_graph_from_file(std::string path, SQLQuerier *querier);
+
+    /** Adds every relationship in a CAIDA as-rel file to the graph.
+     *
+     *  The file is memory mapped and parsed in place without allocating per line.
+     *  Comment lines starting with '#' are skipped and malformed lines are counted.
+     *
+     * @param path Location of the as-rel file
+     * @return false if the file could not be read
+     */
+    bool add_relationships_from_file(std::string path);
+
     /** Remove the stub ASes from the graph.
      *
      * @param querier
@@ -139,6 +233,11 @@ public:
      */
     virtual void save_non_stubs_to_db(SQLQuerier *querier);
 
+    /** Record each non-stub AS's position in non_stubs, which is its bit in
+     *  the inverse results.
+     */
+    void index_non_stubs();
+
     /** Generate a csv with all supernodes, then dump them to database.
      *
      * @param querier
@@ -152,23 +251,107 @@ public:
      *  rank 4, but not possible to have an AS of rank 3 below one of rank 2. 
      *
      *  The bottom of the DAG is rank 0. 
+     *
+     *  Ranks are assigned by a topological levelization (Kahn's algorithm) that 
+     *  visits every provider edge once. Each rank lists its AS ids in id order.
+     *
+     *  This is the last step of graph processing, so it first assigns the dense
+     *  AS ids and builds the adjacency arrays used during propagation. The ids
+     *  are then renumbered rank-major when rank_major_ids is set, and the rows
+     *  are sorted into propagation order.
      */
     virtual void decide_ranks();
 
+    /** Sort every adjacency row into propagation order, the order in which 
+     *  the neighbors are visited: customers and peers by rank from the bottom 
+     *  up, providers by rank from the top down, and by ASN within a rank.
+     *
+     *  An AS that pulls from its neighbors in row order then sees their 
+     *  announcements in the same order as if each neighbor had pushed them 
+     *  when it was visited.
+     */
+    void sort_rows_by_rank();
+
+    /** Renumber the dense ids so every rank occupies a contiguous id range, from
+     *  the bottom of the DAG up, keeping the order of ASes within each rank.
+     *
+     *  ASes handled one after another during propagation then sit next to each
+     *  other in ases_by_id and the adjacency arrays. Neighbors keep their order 
+     *  within each row, so propagation results do not change.
+     */
+    void renumber_by_rank();
+
+    /** Number of ASes in each rank, from the bottom of the DAG up.
+     *
+     *  @return width of every rank, valid after decide_ranks
+     */
+    std::vector<uint32_t> rank_widths() const;
+
+    /** Assign every AS a dense id in 0..N-1 and flatten the provider, peer, 
+     *  and customer sets of every AS into CSR arrays of ids.
+     *
+     *  Must be rerun whenever the set of ASes or their relationships change.
+     */
+    virtual void build_adjacency();
+
+    //****************** Topology Snapshot ******************//
+
+    /** Write the processed graph to a binary snapshot file.
+     *
+     *  Must be called after decide_ranks. The file is written next to path and
+     *  renamed into place, so a concurrent reader never sees a partial snapshot.
+     *
+     *  @param path Location of the snapshot file
+     *  @param source_hash Content hash of the relationship tables the graph was built from
+     *  @return true if the snapshot was written
+     */
+    virtual bool save_snapshot(std::string path, std::string source_hash);
+
+    /** Populate an empty graph from a binary snapshot file written by save_snapshot.
+     *
+     *  The file is memory mapped and rejected if its version or source hash 
+     *  does not match, or if its counts, adjacency rows, or ranks are
+     *  inconsistent. On success the graph is in the same state as after 
+     *  process, with ids, adjacency arrays, and ranks ready for propagation.
+     *
+     *  @param path Location of the snapshot file
+     *  @param source_hash Content hash of the current relationship tables
+     *  @return true if the graph was loaded, false if it must be built from the database
+     */
+    virtual bool load_snapshot(std::string path, std::string source_hash);
+
     //****************** Supernode Generation ******************//
 
-    /** Tarjan driver to detect strongly connected components in the ASGraph.
+    /** Detect strongly connected components with tarjan, or with parallel_scc
+     *  when scc_threads is greater than one.
+     */
+    virtual void find_components();
+
+    /** Tarjan algorithm to detect strongly connected components in the ASGraph.
      * 
+     * Iterative over the dense ids, so deep provider chains cannot overflow the stack.
      * https://en.wikipedia.org/wiki/Tarjan%27s_strongly_connected_components_algorithm
      */
     virtual void tarjan();
 
-    /** Tarjan algorithm to detect strongly connected components in the ASGraph.
-    */
-    virtual void tarjan_helper(ASType *as, int &index, std::stack<ASType*> &s);
+    /** Parallel forward-backward algorithm to detect strongly connected components.
+     *
+     * ASes without a provider or without a customer are trimmed off as single 
+     * components first. The remaining core is split around a pivot into the 
+     * component of the pivot, its forward set, its backward set, and the rest, 
+     * and the three remainders are solved independently by a pool of threads.
+     * Components are emitted sorted by their lowest ASN.
+     *
+     * @param num_threads Number of worker threads
+     */
+    virtual void parallel_scc(uint32_t num_threads);
 
     /** Combine providers, peers, and customers of ASes in a strongly connected component.
      *  Also append to component_translation for future reference.
+     *
+     *  Uses the ids and adjacency arrays built by find_components, so it must 
+     *  directly follow it. Every AS adjacent to a supernode has its relationship
+     *  sets rewritten once, and provider or customer relationships supersede peering.
      */
     virtual void combine_components();
 
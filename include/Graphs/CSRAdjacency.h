@@ -0,0 +1,134 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef CSR_ADJACENCY_H
+#define CSR_ADJACENCY_H
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+/** Compressed sparse row (CSR) storage for one relationship class of the graph.
+ *
+ *  The neighbors of row i are stored contiguously in
+ *  neighbors[offsets[i]] ... neighbors[offsets[i+1] - 1], so walking the
+ *  neighbors of an AS is a linear scan instead of a red-black tree traversal.
+ *  Rows are filled in order with append_row() and the arrays are never
+ *  modified during propagation.
+ */
+struct CSRAdjacency {
+    std::vector<uint32_t> offsets;      // Row start positions, one extra sentinel at the end
+    std::vector<uint32_t> neighbors;    // All rows concatenated
+
+    /** Range over a single row, usable in a range-based for loop.
+    */
+    struct Row {
+        const uint32_t *first;
+        const uint32_t *last;
+        const uint32_t *begin() const { return first; }
+        const uint32_t *end() const { return last; }
+        uint32_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+
+    CSRAdjacency() { offsets.push_back(0); }
+
+    /** Drop all rows and reserve space for a new build.
+     *
+     * @param num_rows Expected number of rows
+     * @param num_neighbors Expected total number of neighbors over all rows
+     */
+    void reset(size_t num_rows, size_t num_neighbors) {
+        offsets.clear();
+        neighbors.clear();
+        offsets.reserve(num_rows + 1);
+        neighbors.reserve(num_neighbors);
+        offsets.push_back(0);
+    }
+
+    /** Append the next row.
+     *
+     * @param row_neighbors The neighbors of the AS occupying this row
+     */
+    void append_row(const std::vector<uint32_t> &row_neighbors) {
+        neighbors.insert(neighbors.end(), row_neighbors.begin(), row_neighbors.end());
+        offsets.push_back(neighbors.size());
+    }
+
+    /** Remove neighbors from their rows in one compacting pass.
+     *
+     *  Only rows from the first affected one onwards are moved, and the 
+     *  remaining neighbors keep their order.
+     *
+     * @param edges (row, neighbor) pairs to remove
+     */
+    void remove_neighbors(std::vector<std::pair<uint32_t, uint32_t>> edges) {
+        if (edges.empty())
+            return;
+        std::sort(edges.begin(), edges.end());
+        uint32_t write = offsets[edges.front().first];
+        size_t e = 0;
+        for (uint32_t i = edges.front().first; i < num_rows(); i++) {
+            uint32_t start = offsets[i];
+            uint32_t end = offsets[i + 1];
+            offsets[i] = write;
+            // Removals for this row
+            size_t first_edge = e;
+            while (e < edges.size() && edges[e].first == i)
+                e++;
+            for (uint32_t k = start; k < end; k++) {
+                bool removed = false;
+                for (size_t r = first_edge; r < e; r++)
+                    removed = removed || edges[r].second == neighbors[k];
+                if (!removed)
+                    neighbors[write++] = neighbors[k];
+            }
+        }
+        offsets[num_rows()] = write;
+        neighbors.resize(write);
+    }
+
+    /** Sort the neighbors within every row.
+     *
+     * @param less Strict weak ordering over neighbor ids
+     */
+    template <class Compare>
+    void sort_rows(Compare less) {
+        for (uint32_t i = 0; i < num_rows(); i++)
+            std::sort(neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1], less);
+    }
+
+    /** Neighbors of a row.
+    */
+    Row row(uint32_t i) const {
+        const uint32_t *base = neighbors.data();
+        return Row{base + offsets[i], base + offsets[i + 1]};
+    }
+
+    /** Number of rows.
+    */
+    uint32_t num_rows() const { return offsets.size() - 1; }
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef TOPOLOGY_SNAPSHOT_H
+#define TOPOLOGY_SNAPSHOT_H
+
+#include <cstdint>
+
+#define TOPOLOGY_SNAPSHOT_MAGIC "BGPTOPO"
+#define TOPOLOGY_SNAPSHOT_VERSION 2
+#define TOPOLOGY_SNAPSHOT_HASH_SIZE 64
+
+/** Fixed header at the start of a binary topology snapshot.
+ *
+ *  A snapshot holds a fully processed graph so later runs can skip building it
+ *  from the database. All values are in host byte order. The header is followed
+ *  by these arrays of uint32_t, in order:
+ *
+ *      asn[num_ases]                       ASN of each dense AS id
+ *      rank[num_ases]                      Rank of each dense AS id
+ *      provider offsets[num_ases + 1], provider neighbors[num_provider_edges]
+ *      peer offsets[num_ases + 1], peer neighbors[num_peer_edges]
+ *      customer offsets[num_ases + 1], customer neighbors[num_customer_edges]
+ *      stubs[2 * num_stubs]                (stub ASN, parent ASN) pairs
+ *      translations[2 * num_translations]  (member ASN, supernode ASN) pairs
+ *      non_stubs[num_non_stubs]
+ *
+ *  Adjacency rows are stored in propagation order (see sort_rows_by_rank).
+ *  The version must be bumped whenever this layout or that order changes.
+ */
+struct TopologySnapshotHeader {
+    char magic[8];                                  // TOPOLOGY_SNAPSHOT_MAGIC, NUL terminated
+    uint32_t version;                               // TOPOLOGY_SNAPSHOT_VERSION
+    uint32_t header_size;                           // sizeof(TopologySnapshotHeader)
+    char source_hash[TOPOLOGY_SNAPSHOT_HASH_SIZE];  // Content hash of the relationship tables, NUL padded
+    uint64_t num_ases;
+    uint64_t num_provider_edges;
+    uint64_t num_peer_edges;
+    uint64_t num_customer_edges;
+    uint64_t num_stubs;
+    uint64_t num_translations;
+    uint64_t num_non_stubs;
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef PATH_TABLE_H
+#define PATH_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/** Hash-consed store of AS paths shared by every announcement in a run.
+ *
+ *  A path is a node (asn, parent) in a persistent parent-pointer tree, where
+ *  asn is the last ASN appended and parent is the id of the path before it.
+ *  Announcements only carry the 32-bit id of their node, so copying one never
+ *  touches the heap, and appending a hop is a single lookup in the table.
+ *  Equal paths always get the same id, so comparing two paths is comparing
+ *  two integers. The full path is only walked when it is needed, e.g. for
+ *  loop checks or when writing results.
+ *
+ *  Id 0 is the empty path. Nodes live in fixed-size chunks that never move,
+ *  so a path can be walked without locking while other threads extend paths.
+ *
+ *  Like the PrefixTable, there is a single instance:
+ *
+ *  uint32_t path = PathTable::getInstance().extend(ann.path_id, asn);
+ *  std::vector<uint32_t> hops = PathTable::getInstance().materialize(path);
+ */
+class PathTable {
+public:
+    static const uint32_t EMPTY_PATH = 0;
+
+    /** Returns the single instance of the table, creating it on first use.
+     */
+    static PathTable& getInstance();
+
+    ~PathTable();
+
+    PathTable(const PathTable&) = delete;
+    PathTable& operator=(const PathTable&) = delete;
+
+    /** Get the id of a path with one more ASN appended.
+     *
+     * @param path The id of the path to extend
+     * @param asn The ASN to append
+     * @return The id of the extended path
+     */
+    uint32_t extend(uint32_t path, uint32_t asn);
+
+    /** Get the id of a path given as a vector, appending from the front.
+     *
+     * @param path The ASNs of the path, first appended first
+     * @return The id of the path
+     */
+    uint32_t intern(const std::vector<uint32_t> &path);
+
+    /** The last ASN appended to a path.
+     *
+     * @param path The id of a non-empty path
+     * @return The ASN of the path's node
+     */
+    uint32_t asn(uint32_t path) const {
+        return node(path).asn;
+    }
+
+    /** The path without its last ASN.
+     *
+     * @param path The id of a non-empty path
+     * @return The id of the parent path
+     */
+    uint32_t parent(uint32_t path) const {
+        return node(path).parent;
+    }
+
+    /** Number of ASNs on a path.
+     */
+    uint32_t length(uint32_t path) const {
+        return node(path).length;
+    }
+
+    /** Check whether an ASN appears anywhere on a path.
+     *
+     * @param path The id of the path to walk
+     * @param asn The ASN to look for
+     * @return true if the ASN is on the path
+     */
+    bool contains(uint32_t path, uint32_t asn) const;
+
+    /** Expand a path into its ASNs, first appended first.
+     *
+     * @param path The id of the path
+     * @return The ASNs of the path
+     */
+    std::vector<uint32_t> materialize(uint32_t path) const;
+
+    /** Drop every path but the empty one. Ids handed out before are invalid
+     *  afterwards, so this may only be called between runs, once no
+     *  announcement refers to a path anymore.
+     */
+    void clear();
+
+    /** Number of paths interned so far, including the empty path.
+     */
+    size_t size() const;
+
+private:
+    struct Node {
+        uint32_t asn;
+        uint32_t parent;
+        uint32_t length;
+    };
+
+    static const uint32_t CHUNK_BITS = 16;
+    static const uint32_t CHUNK_SIZE = 1 << CHUNK_BITS;
+    static const uint32_t NUM_CHUNKS = 1 << (32 - CHUNK_BITS);
+
+    std::atomic<Node*> *chunks;                 // Fixed directory of node chunks
+    uint32_t count;                             // Number of ids handed out
+    std::unordered_map<uint64_t, uint32_t> ids; // Packed (parent, asn) to id
+    mutable std::mutex lock;                    // Guards count and ids
+
+    PathTable();
+
+    const Node& node(uint32_t path) const {
+        return chunks[path >> CHUNK_BITS].load(std::memory_order_acquire)[path & (CHUNK_SIZE - 1)];
+    }
+
+    static uint64_t key(uint32_t parent, uint32_t asn) {
+        return (static_cast<uint64_t>(parent) << 32) | asn;
+    }
+};
+#endif
@@ -34,6 +34,9 @@
 template <typename Integer = uint32_t>
 class Prefix {
 public:
+    // Width of the address in bits, 32 for IPv4 and 128 for IPv6
+    static const int BITS = sizeof(Integer) * 8;
+
     Integer addr;
     Integer netmask;
     
@@ -43,196 +46,295 @@ public:
 
     /** Integer input constructor
      */
-    Prefix(uint32_t addr_in, uint32_t mask_in) {
+    Prefix(Integer addr_in, Integer mask_in) {
         addr = addr_in;
         netmask = mask_in;
     }
 
-    Prefix(const Prefix &p2) {
-        this->addr = p2.addr;
-        this->netmask = p2.netmask;
-    }
+    Prefix(const Prefix &p2) = default;
         
     /** Priority constructor
      *
-     * Takes a ipv4 address as input and converts it into two integers
+     * Takes an address as input and converts it into two integers. The
+     * address family follows the width of Integer.
      *
      * @param addr_str The IP address as a string.
      * @param mask_str The subnet mask/length as a string.
      */ 
     Prefix(std::string addr_str, std::string mask_str) {
-        // IPv4 Address Parsing
         addr = addr_to_int(addr_str);  
         netmask = mask_to_int(mask_str);  
     }
+
+    /** Priority constructor for raw field bytes
+     *
+     * Parses the address and netmask in place, so seeding can hand over the
+     * bytes of a database field without building strings.
+     *
+     * @param addr_str The IP address as a null-terminated string.
+     * @param mask_str The subnet mask as a null-terminated string.
+     */ 
+    Prefix(const char *addr_str, const char *mask_str) {
+        addr = addr_to_int(addr_str);
+        netmask = mask_to_int(mask_str);
+    }
     
     
-    /** Converts a IPv4 address as a string into a integer.
+    /** Parses a dotted quad without copying or allocating.
      *
-     *  This is IPv4 only.
+     *  Each octet must be one to three decimal digits no greater than 255, and
+     *  the string must end right after the fourth octet.
      *
-     *  @return ipv4_ip_int An integer representation of an address
+     *  @param str The dotted quad as a null-terminated string
+     *  @param out Receives the integer representation on success
+     *  @return true if str was a well formed dotted quad
      */
-    uint32_t addr_to_int(std::string addr_str) const {
-        int counter = 0;                // Check for proper addr length
-        size_t pos = 0;                 // Position in string addr
-        uint32_t ipv4_ip_int = 0;       // Stores the address as an int
-        std::string token;              // Buffer subseciton of addr
-        std::string delimiter = ".";    // String dilimiter
-        bool error_f = false;           // Error flag, drops malformed input
-       
-        // Create a copy of address string
-        std::string s = addr_str;
-        if (s.empty()) {
-            error_f = true;
-        } else {
-            while ((pos = s.find(delimiter)) != std::string::npos) {
-                // Catch long malformed input
-                if (counter > 3) {
-                    error_f = true;
-                    break;
+    static bool parse_dotted_quad(const char *str, uint32_t &out) {
+        uint32_t result = 0;
+        for (int octet = 0; octet < 4; octet++) {
+            if (octet > 0 && *str++ != '.') {
+                return false;
+            }
+            uint32_t value = 0;
+            int digits = 0;
+            while (*str >= '0' && *str <= '9' && digits < 3) {
+                value = value * 10 + (*str - '0');
+                str++;
+                digits++;
+            }
+            // A fourth digit makes the octet too long, even with leading zeros
+            if (digits == 0 || value > 255 || (*str >= '0' && *str <= '9')) {
+                return false;
+            }
+            result = (result << 8) | value;
+        }
+        if (*str != '\0') {
+            return false;
+        }
+        out = result;
+        return true;
+    }
+
+
+    /** Parses an IPv6 address in the text form of RFC 4291 without allocating.
+     *
+     *  Accepts up to eight groups of one to four hex digits, at most one "::"
+     *  standing for a run of zero groups, and a dotted quad in place of the
+     *  last two groups (e.g. ::ffff:192.0.2.1).
+     *
+     *  @param str The address as a null-terminated string
+     *  @param out Receives the integer representation on success
+     *  @return true if str was a well formed IPv6 address
+     */
+    static bool parse_ipv6(const char *str, unsigned __int128 &out) {
+        uint16_t groups[8];
+        int num_groups = 0;
+        int gap = -1;                   // Group index the "::" expands at
+        if (str[0] == ':') {
+            if (str[1] != ':') {
+                return false;
+            }
+            gap = 0;
+            str += 2;
+        }
+        while (*str != '\0') {
+            if (num_groups == 8) {
+                return false;
+            }
+            // A dotted quad fills the last two groups
+            const char *end = str;
+            while (hex_digit(*end) >= 0) {
+                end++;
+            }
+            if (*end == '.') {
+                uint32_t ipv4;
+                if (num_groups > 6 || !parse_dotted_quad(str, ipv4)) {
+                    return false;
                 }
-                // Token is one 8-bit int
-                token = s.substr(0, pos);
-                try {
-                    uint32_t token_int = std::stoul(token); 
-                    // Catch out of range ints, default to 255
-                    if (token_int > 255) {
-                        error_f = true;
-                        break;
+                groups[num_groups++] = ipv4 >> 16;
+                groups[num_groups++] = ipv4 & 0xFFFF;
+                break;
+            }
+            if (end == str || end - str > 4) {
+                return false;
+            }
+            uint32_t value = 0;
+            for (; str != end; str++) {
+                value = (value << 4) | hex_digit(*str);
+            }
+            groups[num_groups++] = value;
+            if (*str == ':') {
+                str++;
+                if (*str == ':') {
+                    if (gap >= 0) {
+                        return false;
                     }
-                    // Add token and shift left 8 bits
-                    ipv4_ip_int += token_int;
-                    ipv4_ip_int = ipv4_ip_int << 8;
-                    // Trim token from addr
-                    s.erase(0, pos + delimiter.length());
-                    counter += 1;
-                } catch (...) {
-                    error_f = true;
-                    break;
+                    gap = num_groups;
+                    str++;
+                } else if (*str == '\0') {
+                    return false;
                 }
+            } else if (*str != '\0') {
+                return false;
             }
-            // Catch short malformed input
-            if (counter != 3) {
-                error_f = true;
-            }
-            // Add last 8-bit token
-            try {
-                uint32_t s_int = std::stoul(s);
-                if (s_int > 255) {
-                    error_f = true;
-                } else {
-                    ipv4_ip_int += s_int;
+        }
+        if (gap >= 0 ? num_groups > 7 : num_groups != 8) {
+            return false;
+        }
+        unsigned __int128 result = 0;
+        for (int i = 0; i <= num_groups; i++) {
+            // Shift in the zero groups the gap stands for
+            if (i == gap) {
+                for (int zero = num_groups; zero < 8; zero++) {
+                    result <<= 16;
                 }
-            } catch(...) {
-                error_f = true;
+            }
+            if (i < num_groups) {
+                result = (result << 16) | groups[i];
             }
         }
-        // Default errors to 0.0.0.0
-        if (error_f == true) {
-            ipv4_ip_int = 0;
-            std::cerr << "Caught malformed IPv4 address: " << addr_str << std::endl;
+        out = result;
+        return true;
+    }
+
+
+    /** Parses an address of the family matching the integer type.
+     */
+    static bool parse_address(const char *str, uint32_t &out) {
+        return parse_dotted_quad(str, out);
+    }
+
+    static bool parse_address(const char *str, unsigned __int128 &out) {
+        return parse_ipv6(str, out);
+    }
+
+
+    /** Converts an address as a string into a integer.
+     *
+     *  @return An integer representation of an address, 0 if malformed
+     */
+    Integer addr_to_int(const char *addr_str) const {
+        Integer addr_int;
+        // Default errors to the unspecified address
+        if (!parse_address(addr_str, addr_int)) {
+            addr_int = 0;
+            std::cerr << "Caught malformed " << family() << " address: " << addr_str << std::endl;
         }
-        return ipv4_ip_int;
+        return addr_int;
+    }
+
+    Integer addr_to_int(const std::string &addr_str) const {
+        return addr_to_int(addr_str.c_str());
     }
     
     
-    /** Converts a IPv4 netmask as a string into a integer.
+    /** Converts a netmask as a string into a integer.
      *
-     *  This is IPv4 only.
+     *  @return An integer representation of a netmask, 0 if malformed
+     */
+    Integer mask_to_int(const char *mask_str) const {
+        Integer mask_int;
+        // Default errors to /0
+        if (!parse_address(mask_str, mask_int)) {
+            mask_int = 0;
+            std::cerr << "Caught malformed " << family() << " subnet mask: " << mask_str << std::endl;
+        }
+        return mask_int;
+    }
+
+    Integer mask_to_int(const std::string &mask_str) const {
+        return mask_to_int(mask_str.c_str());
+    }
+
+
+    /** Name of the address family, for messages.
+     */
+    static const char* family() {
+        return BITS == 32 ? "IPv4" : "IPv6";
+    }
+
+
+    /** Number of leading one bits in the netmask.
      *
-     *  @return ipv4_mask_int An integer representation of a netmask
+     *  Assumes a valid cidr netmask, e.g. no ones after the first zero.
      */
-    uint32_t mask_to_int(std::string mask_str) const {
-        int counter = 0;                // Check for proper addr length
-        size_t pos = 0;                 // Position in string addr
-        uint32_t ipv4_mask_int = 0;     // Stores the netmask as an int
-        std::string token;              // Buffer subseciton of addr
-        std::string delimiter = ".";    // String dilimiter
-        bool error_f = false;           // Error flag, drops malformed input
+    int length() const {
+        int sz = 0;
+        for (int i = 0; i < BITS; i++) {
+            if (netmask & (static_cast<Integer>(1) << i)) {
+                sz++;
+            }
+        }
+        return sz;
+    }
 
-        std::string s = mask_str;
-        if (s.empty()) {
-            error_f = true;
-        } else {
-            while ((pos = s.find(delimiter)) != std::string::npos) { 
-                // Catch long malformed input
-                if (counter > 3) {
-                    error_f = true;
-                    break;
-                }
-                // Token is one 8-bit int
-                token = s.substr(0, pos);
-                try {
-                    uint32_t token_int = std::stoul(token);
-                    // Catch out of range ints, default to 255
-                    if (token_int > 255) {
-                        error_f = true;
-                        break;
-                    }
-                    // Add token and shift left 8 bits
-                    ipv4_mask_int += std::stoul(token);
-                    ipv4_mask_int = ipv4_mask_int << 8;
-                    // Trim token from addr
-                    s.erase(0, pos + delimiter.length());
-                    counter += 1;
-                }
-                catch (...) {
-                    error_f = true;
-                    break;
-                }
+
+    /** Formats an IPv4 address as a dotted quad.
+     */
+    static std::string addr_to_string(uint32_t address) {
+        std::string str = "";
+        str.append(std::to_string((address >> 24) & 0xFF) + ".");
+        str.append(std::to_string((address >> 16) & 0xFF) + ".");
+        str.append(std::to_string((address >> 8) & 0xFF) + ".");
+        str.append(std::to_string(address & 0xFF));
+        return str;
+    }
+
+    /** Formats an IPv6 address in the canonical text form of RFC 5952.
+     *
+     *  Groups are lower case hex without leading zeros, and the longest run
+     *  of two or more zero groups (the first, on a tie) is replaced by "::".
+     */
+    static std::string addr_to_string(unsigned __int128 address) {
+        uint16_t groups[8];
+        for (int i = 0; i < 8; i++) {
+            groups[i] = static_cast<uint16_t>(address >> (16 * (7 - i)));
+        }
+        // Find the longest run of zero groups
+        int best_start = -1, best_len = 1;
+        for (int i = 0; i < 8; ) {
+            int len = 0;
+            while (i + len < 8 && groups[i + len] == 0) {
+                len++;
             }
-            // Catch short malformed input
-            if (counter != 3) {
-                error_f = true;
+            if (len > best_len) {
+                best_start = i;
+                best_len = len;
             }
-            // Add last 8-bit token
-            try {
-                uint32_t s_int = std::stoul(s);
-                if (s_int > 255) {
-                    error_f = true;
-                } else {
-                    ipv4_mask_int += s_int;
-                }
+            i += (len > 0) ? len : 1;
+        }
+        static const char digits[] = "0123456789abcdef";
+        std::string str = "";
+        for (int i = 0; i < 8; i++) {
+            if (i == best_start) {
+                str.append("::");
+                i += best_len - 1;
+                continue;
             }
-            catch (...) {
-                error_f = true;
+            if (!str.empty() && str.back() != ':') {
+                str.push_back(':');
+            }
+            bool leading = true;
+            for (int shift = 12; shift >= 0; shift -= 4) {
+                int digit = (groups[i] >> shift) & 0xF;
+                if (digit != 0 || shift == 0 || !leading) {
+                    str.push_back(digits[digit]);
+                    leading = false;
+                }
             }
         }
-        // Default errors to /0
-        if (error_f == true) {
-            ipv4_mask_int = 0;
-            std::cerr << "Caught malformed IPv4 subnet mask: " << mask_str << std::endl;
-        }
-        return ipv4_mask_int;
+        return str;
     }
 
 
     /** Converts this prefix into a cidr formatted string.
-     *
-     *  This is IPv4 only.
      *
      *  @return cidr A string in cidr format.
      */
     std::string to_cidr() const {
-        std::string cidr = "";
-        uint8_t quad = (addr & 0xFF000000) >> 24;
-        cidr.append(std::to_string(quad) + ".");
-        quad = (addr & 0x00FF0000) >> 16;
-        cidr.append(std::to_string(quad) + ".");
-        quad = (addr & 0x0000FF00) >> 8;
-        cidr.append(std::to_string(quad) + ".");
-        quad = (addr & 0x000000FF) >> 0;
-        cidr.append(std::to_string(quad));
+        std::string cidr = addr_to_string(addr);
         cidr.push_back('/');
-        // Assume valid cidr netmask, e.g. no ones after the first zero
-        uint8_t sz = 0;
-        for (int i = 0; i < 32; i++) {
-            if (netmask & (1 << i)) {
-                sz++;
-            }
-        }
-        cidr.append(std::to_string(sz));
+        cidr.append(std::to_string(length()));
         return cidr;
     }
     
@@ -245,21 +347,13 @@ public:
      * @return true If the operation holds, otherwise false
      */
     bool operator<(const Prefix &b) const {
-        uint64_t combined = 0;
-        combined |= addr;
-        combined = combined << 32;
-        combined |= netmask; 
-        uint64_t combined_b = 0;
-        combined_b |= b.addr;
-        combined_b = combined_b << 32;
-        combined_b |= b.netmask; 
-        return combined < combined_b;
+        return addr < b.addr || (addr == b.addr && netmask < b.netmask);
     }
     bool operator==(const Prefix &b) const {
-        return !(*this < b || b < *this);
+        return addr == b.addr && netmask == b.netmask;
     }
     bool operator>(const Prefix &b) const {
-        return !(*this < b || *this == b);
+        return b < *this;
     }
     bool operator!=(const Prefix &b) const {
         return !(*this == b);
@@ -273,5 +367,18 @@ public:
     bool contained_in_or_equal_to(const Prefix &b) const {
         return b.netmask <= netmask && (addr & b.netmask) == (b.addr & b.netmask);
     }
+
+private:
+    /** Value of a hex digit, or -1 if c is not one.
+     */
+    static int hex_digit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
 };
+
+template <typename Integer>
+const int Prefix<Integer>::BITS;
 #endif
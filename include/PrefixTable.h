@@ -0,0 +1,166 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef PREFIX_TABLE_H
+#define PREFIX_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Prefix.h"
+
+/** Process-wide dictionary assigning each distinct prefix a compact 32-bit id.
+ *
+ *  Prefixes are interned as announcements are loaded. From then on the RIBs,
+ *  the inverse results and the depref tables only carry the id, which is
+ *  cheap to hash and copy. The prefix itself and its CIDR string, which is
+ *  formatted once on interning, are looked up again when results are written.
+ *
+ *  IPv4 and IPv6 prefixes share one id space, so the RIBs and the result
+ *  writers do not care which family an announcement belongs to. Keying on the
+ *  id keeps 32-byte IPv6 prefixes out of every RIB entry.
+ *
+ *  Ids are handed out densely from zero and never reused, so they can index
+ *  arrays directly. Entries live in fixed-size chunks that never move, so an
+ *  id can be resolved without locking while other threads intern new
+ *  prefixes.
+ *
+ *  Like the Logger, there is a single instance:
+ *
+ *  uint32_t id = PrefixTable::getInstance().intern(prefix);
+ *  os << PrefixTable::getInstance().cidr(id);
+ */
+class PrefixTable {
+public:
+    static const uint32_t NO_PREFIX = UINT32_MAX;
+
+    /** Returns the single instance of the table, creating it on first use.
+     */
+    static PrefixTable& getInstance();
+
+    ~PrefixTable();
+
+    PrefixTable(const PrefixTable&) = delete;
+    PrefixTable& operator=(const PrefixTable&) = delete;
+
+    /** Get the id for a prefix, assigning the next free id if it is new.
+     *
+     * @param prefix The prefix to intern
+     * @return The id of the prefix
+     */
+    uint32_t intern(const Prefix<> &prefix);
+    uint32_t intern(const Prefix<unsigned __int128> &prefix);
+
+    /** Get the id for a prefix without interning it.
+     *
+     * @param prefix The prefix to look up
+     * @return The id of the prefix, or NO_PREFIX if it was never interned
+     */
+    uint32_t lookup(const Prefix<> &prefix) const;
+    uint32_t lookup(const Prefix<unsigned __int128> &prefix) const;
+
+    /** Resolve an id to its prefix.
+     *
+     * @param id An id returned by intern() for an IPv4 prefix
+     * @return The interned prefix
+     */
+    const Prefix<>& prefix(uint32_t id) const {
+        return entry(id).prefix;
+    }
+
+    /** Resolve an id to its IPv6 prefix.
+     *
+     * @param id An id returned by intern() for an IPv6 prefix
+     * @return The interned prefix
+     */
+    const Prefix<unsigned __int128>& prefix6(uint32_t id) const {
+        return entry(id).prefix6;
+    }
+
+    /** Check which family an id belongs to.
+     *
+     * @param id An id returned by intern()
+     * @return true if the id was assigned to an IPv6 prefix
+     */
+    bool is_ipv6(uint32_t id) const {
+        return entry(id).ipv6;
+    }
+
+    /** Resolve an id to the CIDR string of its prefix.
+     *
+     * @param id An id returned by intern()
+     * @return The prefix in CIDR notation
+     */
+    const std::string& cidr(uint32_t id) const {
+        return entry(id).cidr;
+    }
+
+    /** Number of prefixes interned so far.
+     */
+    size_t size() const;
+
+private:
+    struct Entry {
+        Prefix<> prefix;                        // Set for IPv4 ids
+        Prefix<unsigned __int128> prefix6;      // Set for IPv6 ids
+        std::string cidr;
+        bool ipv6;
+    };
+
+    struct Hash6 {
+        size_t operator()(const Prefix<unsigned __int128> &prefix) const {
+            uint64_t key = static_cast<uint64_t>(prefix.addr >> 64) * 0x9E3779B97F4A7C15ULL;
+            key ^= static_cast<uint64_t>(prefix.addr) + (key << 6) + (key >> 2);
+            key ^= static_cast<uint64_t>(prefix.netmask >> 64) + (key << 6) + (key >> 2);
+            return static_cast<size_t>(key);
+        }
+    };
+
+    static const uint32_t CHUNK_BITS = 16;
+    static const uint32_t CHUNK_SIZE = 1 << CHUNK_BITS;
+    static const uint32_t NUM_CHUNKS = 1 << (32 - CHUNK_BITS);
+
+    std::atomic<Entry*> *chunks;                // Fixed directory of entry chunks
+    uint32_t count;                             // Number of ids handed out
+    std::unordered_map<uint64_t, uint32_t> ids; // Packed (addr, netmask) to id
+    std::unordered_map<Prefix<unsigned __int128>, uint32_t, Hash6> ids6;   // IPv6 prefix to id
+    mutable std::mutex lock;                    // Guards count, ids and ids6
+
+    PrefixTable();
+
+    /** Hand out the next id. The caller holds the lock and fills the entry.
+     */
+    Entry& next_entry(uint32_t &id);
+
+    const Entry& entry(uint32_t id) const {
+        return chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+    }
+
+    static uint64_t key(const Prefix<> &prefix) {
+        return (static_cast<uint64_t>(prefix.addr) << 32) | prefix.netmask;
+    }
+};
+#endif
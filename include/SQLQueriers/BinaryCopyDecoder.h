@@ -0,0 +1,66 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef BINARY_COPY_DECODER_H
+#define BINARY_COPY_DECODER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/** Decoder for the output of COPY ... TO STDOUT (FORMAT binary) with integer columns.
+ *
+ *  Fields are read straight from the network byte order representation, so 
+ *  no text is parsed. smallint, integer, and bigint columns are accepted and
+ *  narrowed to uint32_t, a negative value or a bigint above UINT32_MAX is an error. 
+ *  Rows containing a NULL are skipped.
+ */
+class BinaryCopyDecoder {
+public:
+    /** @param num_columns Number of columns every row must have
+    */
+    BinaryCopyDecoder(uint32_t num_columns);
+
+    /** Decode one CopyData message and append the fields of each row to values.
+     *
+     *  The server sends every row in its own message, with the file header 
+     *  ahead of the first row, so a message never ends inside a row.
+     *
+     *  @param data Contents of the message
+     *  @param size Size of the message in bytes
+     *  @param values Buffer receiving num_columns values per row
+     *  @return false if the message is not a valid binary COPY row or a value is out of range
+     */
+    bool decode(const char *data, size_t size, std::vector<uint32_t> &values);
+
+    /** @return true once the end of data trailer was decoded
+    */
+    bool finished() const { return trailer_read; }
+
+private:
+    uint32_t num_columns;
+    bool header_read;
+    bool trailer_read;
+};
+
+#endif
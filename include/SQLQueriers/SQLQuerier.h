@@ -30,6 +30,7 @@
 #include <pqxx/pqxx>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <sstream>
 #include <fstream>
 #include <algorithm>
@@ -60,14 +61,25 @@ public:
     void read_config();
     void open_connection();
     void close_connection();
+    std::string connection_string();
     pqxx::result execute(std::string sql, bool insert = false);
     
     // Select from DB
     pqxx::result select_from_table(std::string table_name, int limit = 0);
+    bool copy_columns_from_db(std::string sql, uint32_t num_columns, std::vector<uint32_t> &values);
     pqxx::result select_prefix_count(Prefix<>*);
+    pqxx::result select_prefix_count(Prefix<unsigned __int128>*);
+    pqxx::result select_prefix_count(const std::string &cidr);
     virtual pqxx::result select_prefix_ann(Prefix<>*);
+    virtual pqxx::result select_prefix_ann(Prefix<unsigned __int128>*);
+    pqxx::result select_prefix_ann(const std::string &cidr);
     pqxx::result select_subnet_count(Prefix<>*);
+    pqxx::result select_subnet_count(Prefix<unsigned __int128>*);
+    pqxx::result select_subnet_count(const std::string &cidr);
+    std::string select_relationships_hash();
     virtual pqxx::result select_subnet_ann(Prefix<>*);
+    virtual pqxx::result select_subnet_ann(Prefix<unsigned __int128>*);
+    pqxx::result select_subnet_ann(const std::string &cidr);
     
     // Preprocessing Tables
     void clear_stubs_from_db();
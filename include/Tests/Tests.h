@@ -57,6 +57,8 @@ bool test_prefix_lt_operator();
 bool test_prefix_gt_operator();
 bool test_prefix_eq_operator();
 bool test_prefix_contained_in_or_equal_to_operator();
+bool test_prefix_table();
+bool test_prefix_ipv6();
 
 // Prototypes for AnnouncementTest.cpp
 bool test_announcement();
@@ -65,6 +67,10 @@ bool test_ann_gt_operator();
 bool test_to_sql();
 bool test_ann_os_operator();
 bool test_to_csv();
+bool test_path_table();
+
+// Prototypes for SQLQuerierTest.cpp
+bool test_binary_copy_decoder();
 
 // Prototypes for ASTest.cpp
 bool test_get_random();
@@ -75,14 +81,22 @@ bool test_process_announcement();
 bool test_process_announcements();
 bool test_already_received();
 bool test_clear_announcements();
+bool test_rib();
+bool test_arena();
+bool test_inverse_results();
 
 // Prototypes for ASGraphTest.cpp
 bool test_add_relationship();
 bool test_translate_asn();
 bool test_decide_ranks();
+bool test_build_adjacency();
 bool test_remove_stubs();
 bool test_tarjan();
+bool test_parallel_scc();
 bool test_combine_components();
+bool test_topology_snapshot();
+bool test_create_graph_from_file();
+bool test_remove_relationships();
 
 // Prototypes for ExtrapolatorTest.cpp
 bool test_Extrapolator_constructor();
@@ -91,6 +105,13 @@ bool test_propagate_down();
 bool test_propagate_down2();
 bool test_give_ann_to_as_path();
 bool test_send_all_announcements();
+bool test_pull_propagation();
+bool test_sparse_propagation();
+bool test_thread_pool();
+bool test_bounded_queue();
+bool test_block_workers();
+bool test_parse_path();
+bool test_give_ann_to_as_path_ipv6();
 
 // Prototypes for ROVppTest.cpp
 bool test_rovpp_ann_eq_operator();
@@ -125,4 +146,7 @@ bool test_rovpp_full_path();
 //EZBGPsec
 bool ezbgpsec_test_path_propagation();
 
+// Prototypes for BenchmarkTests.cpp
+bool benchmark_rank_major_ids();
+
 #endif
@@ -0,0 +1,125 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/** Fixed set of worker threads for data-parallel loops.
+ *
+ *  parallel_for() splits a range into chunks and deals contiguous runs of
+ *  them to the workers and the calling thread. Each thread works through 
+ *  its own chunks from the front and, once out of work, steals from the 
+ *  back of another thread's queue, so uneven chunks do not leave threads 
+ *  idle while others are still busy. It returns once every chunk is done, 
+ *  so consecutive loops are separated by a barrier. The workers sleep 
+ *  between loops and are only started once, which keeps the per-loop 
+ *  overhead low enough to run one loop per rank.
+ */
+class ThreadPool {
+public:
+    /** Start the workers.
+     *
+     * @param num_threads Threads taking part in a loop, including the caller. 1 runs loops inline.
+     */
+    explicit ThreadPool(uint32_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** Threads taking part in a loop, including the caller.
+     */
+    uint32_t size() const { return workers.size() + 1; }
+
+    /** Run body over [0, n) in chunks of at most grain indices and wait for all of them.
+     *
+     * @param n Number of indices
+     * @param body Called with the [begin, end) of each chunk, possibly concurrently
+     * @param grain Largest chunk handed out at once
+     */
+    void parallel_for(size_t n, const std::function<void(size_t, size_t)> &body, size_t grain = 32);
+
+    /** Run body over [0, n) in chunks of about equal estimated cost and wait for all of them.
+     *
+     *  Chunks are cut so every thread starts with several of them, and an
+     *  index costing more than a chunk's share gets a chunk of its own.
+     *
+     * @param n Number of indices
+     * @param cost Estimated cost of each index
+     * @param body Called with the [begin, end) of each chunk, possibly concurrently
+     */
+    void parallel_for(size_t n, const std::vector<uint64_t> &cost, const std::function<void(size_t, size_t)> &body);
+
+    /** Time each thread spent without work while a loop was still running, 
+     *  the caller first, since the last reset_idle.
+     *
+     * @return Idle seconds per thread
+     */
+    std::vector<double> idle_seconds() const;
+
+    /** Start counting idle time from zero.
+     */
+    void reset_idle();
+
+private:
+    typedef std::pair<size_t, size_t> Chunk;
+
+    /** Chunks dealt to one thread. The owner pops from the front, thieves from the back.
+     */
+    struct Queue {
+        std::mutex lock;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;     // One per thread, the caller's first
+    std::mutex lock;
+    std::condition_variable wake;                   // Signals a new loop or shutdown to the workers
+    std::condition_variable finished;               // Signals the caller that the workers are done
+    const std::function<void(size_t, size_t)> *job; // Body of the current loop
+    uint32_t running;                               // Workers still inside the current loop
+    uint64_t generation;                            // Number of loops started
+    bool stopping;
+    std::vector<std::chrono::steady_clock::time_point> out_of_work; // When each thread last ran dry
+    std::vector<double> idle;                       // Idle seconds per thread
+
+    /** Deal the chunks to the threads, run the loop, and wait for it.
+     */
+    void run(std::vector<Chunk> &chunks, const std::function<void(size_t, size_t)> &body);
+    void work(uint32_t self);
+    void run_chunks(uint32_t self);
+    bool take(uint32_t self, Chunk &chunk);
+};
+#endif
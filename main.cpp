@@ -95,6 +95,33 @@ int main(int argc, char *argv[]) {
         ("prop-twice,k",
          po::value<bool>()->default_value(true),
          "flag whether or not to propagate twice")
+        ("scc-threads,c",
+         po::value<uint32_t>()->default_value(1),
+         "number of threads for supernode detection, 1 uses Tarjan")
+        ("threads,j",
+         po::value<uint32_t>()->default_value(1),
+         "number of threads propagating the ASes of a rank in parallel")
+        ("block-workers,w",
+         po::value<uint32_t>()->default_value(1),
+         "number of prefix blocks extrapolated at the same time")
+        ("pipeline-depth,q",
+         po::value<uint32_t>()->default_value(0),
+         "blocks queued between fetching, propagating, and saving, 0 disables pipelining")
+        ("sparse,x",
+         po::value<bool>()->default_value(false),
+         "only visit the ASes a block reaches during propagation")
+        ("pull,y",
+         po::value<bool>()->default_value(true),
+         "pull announcements from neighbors' Loc-RIBs, false falls back to push propagation")
+        ("topology-snapshot,g",
+         po::value<string>()->default_value(""),
+         "binary topology snapshot to load, rebuilt when missing or stale")
+        ("as-rel-file,e",
+         po::value<string>()->default_value(""),
+         "CAIDA as-rel file to build the graph from instead of the database")
+        ("ipv6,6",
+         po::value<bool>()->default_value(false),
+         "also extrapolate IPv6 announcements, in blocks of their own")
         ("log-folder,l",
          po::value<string>()->default_value(""),
          "enables the use of logging, best used for debugging only");
@@ -138,6 +165,7 @@ int main(int argc, char *argv[]) {
             (vm.count("simulation-table") ?
                 vm["simulation-table"].as<string>() : 
                 ROVPP_SIMULATION_TABLE));
+        extrap->graph->scc_threads = vm["scc-threads"].as<uint32_t>();
             
         // Run propagation
         bool prop_twice = vm["prop-twice"].as<bool>();
@@ -165,6 +193,12 @@ int main(int argc, char *argv[]) {
             vm["iteration-size"].as<uint32_t>(),
             vm["ezbgpsec"].as<uint32_t>(),
             vm["num-in-between"].as<uint32_t>());
+        extrap->graph->scc_threads = vm["scc-threads"].as<uint32_t>();
+        extrap->threads = vm["threads"].as<uint32_t>();
+        extrap->pipeline_depth = vm["pipeline-depth"].as<uint32_t>();
+        extrap->sparse_propagation = vm["sparse"].as<bool>();
+        extrap->pull_propagation = vm["pull"].as<bool>();
+        extrap->as_rel_file = vm["as-rel-file"].as<string>();
             
         // Run propagation
         extrap->perform_propagation();
@@ -189,6 +223,15 @@ int main(int argc, char *argv[]) {
                 vm["depref-table"].as<string>() : 
                 DEPREF_RESULTS_TABLE),
             (vm["iteration-size"].as<uint32_t>()));
+        extrap->graph->scc_threads = vm["scc-threads"].as<uint32_t>();
+        extrap->threads = vm["threads"].as<uint32_t>();
+        extrap->pipeline_depth = vm["pipeline-depth"].as<uint32_t>();
+        extrap->sparse_propagation = vm["sparse"].as<bool>();
+        extrap->pull_propagation = vm["pull"].as<bool>();
+        extrap->block_workers = vm["block-workers"].as<uint32_t>();
+        extrap->topology_snapshot = vm["topology-snapshot"].as<string>();
+        extrap->as_rel_file = vm["as-rel-file"].as<string>();
+        extrap->ipv6 = vm["ipv6"].as<bool>();
             
         // Run propagation
         extrap->perform_propagation();
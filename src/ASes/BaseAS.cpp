@@ -27,13 +27,12 @@ BaseAS<AnnouncementType>::~BaseAS() {
     delete incoming_announcements;
     delete all_anns;
 
-    if(depref_anns != NULL)
-        delete depref_anns;
-    
-    delete peers;
-    delete providers;
-    delete customers;
-    delete member_ases;
+    if (owns_topology) {
+        delete peers;
+        delete providers;
+        delete customers;
+        delete member_ases;
+    }
 }
 
 template <class AnnouncementType>
@@ -74,19 +73,39 @@ void BaseAS<AnnouncementType>::remove_neighbor(uint32_t asn, int relationship) {
     }
 }
 
+template <class AnnouncementType>
+void BaseAS<AnnouncementType>::share_topology(const BaseAS<AnnouncementType> &other) {
+    if (owns_topology) {
+        delete peers;
+        delete providers;
+        delete customers;
+        delete member_ases;
+    }
+    providers = other.providers;
+    peers = other.peers;
+    customers = other.customers;
+    member_ases = other.member_ases;
+    owns_topology = false;
+
+    asn = other.asn;
+    rank = other.rank;
+    id = other.id;
+    non_stub_index = other.non_stub_index;
+}
+
 //****************** Announcement Handling ******************//
 
 template <class AnnouncementType>
-void BaseAS<AnnouncementType>::swap_inverse_result(std::pair<Prefix<>,uint32_t> old, std::pair<Prefix<>,uint32_t> current) {
+void BaseAS<AnnouncementType>::swap_inverse_result(std::pair<uint32_t, uint32_t> old, std::pair<uint32_t, uint32_t> current) {
     if (inverse_results != NULL) {
         // Add back to old set, remove from new set
         auto set = inverse_results->find(old);
         if (set != inverse_results->end()) {
-            set->second->insert(asn);
+            set->second->set(non_stub_index);
         }
         set = inverse_results->find(current);
         if (set != inverse_results->end()) {
-            set->second->erase(asn);
+            set->second->reset(non_stub_index);
         }
     }
 }
@@ -102,21 +121,21 @@ void BaseAS<AnnouncementType>::receive_announcements(std::vector<AnnouncementTyp
 template <class AnnouncementType>
 void BaseAS<AnnouncementType>::process_announcement(AnnouncementType &ann, bool ran) {
     // Check for existing announcement for prefix
-    auto search = all_anns->find(ann.prefix);
+    auto search = all_anns->find(ann.prefix_id);
     
     // No announcement found for incoming announcement prefix
     if (search == all_anns->end()) {
-        all_anns->insert(std::pair<Prefix<>, AnnouncementType>(ann.prefix, ann));
+        all_anns->insert(std::pair<uint32_t, AnnouncementType>(ann.prefix_id, ann));
         // Inverse results need to be computed also with announcements from monitors
         if (inverse_results != NULL) {
             auto set = inverse_results->find(
-                std::pair<Prefix<>,uint32_t>(ann.prefix, ann.origin));
+                std::pair<uint32_t, uint32_t>(ann.prefix_id, ann.origin));
             if (set != inverse_results->end()) {
-                set->second->erase(asn);
+                set->second->reset(non_stub_index);
             }
         }
     } else {
-        // Logger::getInstance().log("Matching_Prefixes") << "Received an additional announcement for prefix:" << ann.prefix.to_cidr() << ", tstamp on processing announcement: " 
+        // Logger::getInstance().log("Matching_Prefixes") << "Received an additional announcement for prefix:" << ann.prefix().to_cidr() << ", tstamp on processing announcement: " 
         //             << ann.tstamp << ", timestamp on stored announcement: " << search->second.tstamp
         //             << ", origin on processing announcement: " << ann.origin << ", origin on stored announcement: " << search->second.origin;
 
@@ -129,7 +148,7 @@ void BaseAS<AnnouncementType>::process_announcement(AnnouncementType &ann, bool
                 value = get_random();
             }
 
-            // Logger::getInstance().log("Equal_Priority") << "Equal Priority announcements on prefix: " << ann.prefix.to_cidr() << 
+            // Logger::getInstance().log("Equal_Priority") << "Equal Priority announcements on prefix: " << ann.prefix().to_cidr() << 
             //         ", rand value: " << value << ", tstamp on processing announcement: " << ann.tstamp << ", timestamp on stored announcement: " << search->second.tstamp
             //         << ", origin on processing announcement: " << ann.origin << ", origin on stored announcement: " << search->second.origin;
 
@@ -138,65 +157,42 @@ void BaseAS<AnnouncementType>::process_announcement(AnnouncementType &ann, bool
                 // Update inverse results
                 if(inverse_results != NULL) {
                     swap_inverse_result(
-                        std::pair<Prefix<>, uint32_t>(search->second.prefix, search->second.origin),
-                        std::pair<Prefix<>, uint32_t>(ann.prefix, ann.origin));
+                        std::pair<uint32_t, uint32_t>(search->second.prefix_id, search->second.origin),
+                        std::pair<uint32_t, uint32_t>(ann.prefix_id, ann.origin));
                 }
 
-                // Use the new announcement
-                if(depref_anns != NULL) {
-                    auto search_depref = depref_anns->find(ann.prefix);
-                    if (search_depref == depref_anns->end())
-                        // Insert depref ann
-                        depref_anns->insert(std::pair<Prefix<>, AnnouncementType>(search->second.prefix, search->second));
-                    else
-                        search_depref->second = search->second;
-                }
+                // Use the new announcement, the old one becomes second best
+                if(all_anns->stores_depref())
+                    all_anns->set_depref(search, search->second);
 
                 search->second = ann;
-            } else if(depref_anns != NULL) {
-                auto search_depref = depref_anns->find(ann.prefix);
-
-                // Use the old announcement
-                if (search_depref == depref_anns->end()) {
-                    // Insert new second best announcement
-                    depref_anns->insert(std::pair<Prefix<>, AnnouncementType>(ann.prefix, ann));
-                } else {
-                    // Replace second best with the old priority announcement
-                    search_depref->second = ann;
-                }
+            } else if(all_anns->stores_depref()) {
+                // Use the old announcement, the new one becomes second best
+                all_anns->set_depref(search, ann);
             }
         // Otherwise check new announcements priority for best path selection
         } else if (ann.priority > search->second.priority) {
             if(inverse_results != NULL) {
                 // Update inverse results
                 swap_inverse_result(
-                    std::pair<Prefix<>, uint32_t>(search->second.prefix, search->second.origin),
-                    std::pair<Prefix<>, uint32_t>(ann.prefix, ann.origin));
+                    std::pair<uint32_t, uint32_t>(search->second.prefix_id, search->second.origin),
+                    std::pair<uint32_t, uint32_t>(ann.prefix_id, ann.origin));
             }
 
-            if(depref_anns != NULL) {
-                auto search_depref = depref_anns->find(ann.prefix);
-                if (search_depref == depref_anns->end()) {
-                    // Insert new second best announcement
-                    depref_anns->insert(std::pair<Prefix<>, AnnouncementType>(search->second.prefix, search->second));
-                } else {
-                    // Replace second best with the old priority announcement
-                    search_depref->second = search->second;
-                }
+            if(all_anns->stores_depref()) {
+                // Replace second best with the old priority announcement
+                all_anns->set_depref(search, search->second);
             }
 
             // Replace the old announcement with the higher priority
             search->second = ann;
         // Old announcement was better
         // Check depref announcements priority for best path selection
-        } else if(depref_anns != NULL) {
-            auto search_depref = depref_anns->find(ann.prefix);
-            if (search_depref == depref_anns->end()) {
-                // Insert new second best annoucement
-                depref_anns->insert(std::pair<Prefix<>, AnnouncementType>(ann.prefix, ann));
-            } else if (ann.priority > search_depref->second.priority) {
+        } else if(all_anns->stores_depref()) {
+            AnnouncementType *depref = all_anns->depref(search);
+            if (depref == NULL || ann.priority > depref->priority) {
                 // Replace the old depref announcement with the higher priority
-                search_depref->second = search->second;
+                all_anns->set_depref(search, ann);
             }
         }
     }
@@ -205,7 +201,7 @@ void BaseAS<AnnouncementType>::process_announcement(AnnouncementType &ann, bool
 template <class AnnouncementType>
 void BaseAS<AnnouncementType>::process_announcements(bool ran) {
     for (auto &ann : *incoming_announcements) {
-        auto search = all_anns->find(ann.prefix);
+        auto search = all_anns->find(ann.prefix_id);
         if (search == all_anns->end() || !search->second.from_monitor) {
             process_announcement(ann, ran);
         }
@@ -216,27 +212,38 @@ void BaseAS<AnnouncementType>::process_announcements(bool ran) {
 template <class AnnouncementType>
 void BaseAS<AnnouncementType>::clear_announcements() {
     all_anns->clear();
-    incoming_announcements->clear();
+    Arena *arena = incoming_announcements->get_allocator().arena;
+    if (arena != NULL) {
+        // Arena storage is dropped here and reclaimed when the arena is reset
+        std::vector<AnnouncementType, ArenaAllocator<AnnouncementType>>(
+            ArenaAllocator<AnnouncementType>(arena)).swap(*incoming_announcements);
+    } else {
+        incoming_announcements->clear();
+    }
+}
 
-    if(depref_anns != NULL)
-        depref_anns->clear();
+template <class AnnouncementType>
+void BaseAS<AnnouncementType>::use_arena(Arena *arena) {
+    all_anns->use_arena(arena);
+    std::vector<AnnouncementType, ArenaAllocator<AnnouncementType>>(
+        ArenaAllocator<AnnouncementType>(arena)).swap(*incoming_announcements);
 }
 
 template <class AnnouncementType>
 bool BaseAS<AnnouncementType>::already_received(AnnouncementType &ann) {
-    auto search = all_anns->find(ann.prefix);
+    auto search = all_anns->find(ann.prefix_id);
     bool found = (search == all_anns->end()) ? false : true;
     return found;
 }
 
 template <class AnnouncementType>
 void BaseAS<AnnouncementType>::delete_ann(AnnouncementType &ann) {
-    all_anns->erase(ann.prefix);
+    all_anns->erase(ann.prefix_id);
 }
 
 template <class AnnouncementType>
-void BaseAS<AnnouncementType>::delete_ann(Prefix<> &prefix) {
-    all_anns->erase(prefix);
+void BaseAS<AnnouncementType>::delete_ann(uint32_t prefix_id) {
+    all_anns->erase(prefix_id);
 }
 
 //****************** FILE I/O ******************//
@@ -266,17 +273,37 @@ template <class AnnouncementType>
 std::ostream& BaseAS<AnnouncementType>::stream_announcements(std::ostream &os) {
     for (auto &ann : *all_anns) {
         os << asn << ',';
-        ann.second.to_csv(os);
+        to_csv(os, ann.second);
+    }
+    return os;
+}
+
+template <class AnnouncementType>
+std::ostream& BaseAS<AnnouncementType>::stream_announcements(std::ostream &os, std::ostream &depref_os) {
+    if (!all_anns->stores_depref())
+        return stream_announcements(os);
+
+    for (auto it = all_anns->begin(); it != all_anns->end(); ++it) {
+        os << asn << ',';
+        to_csv(os, it->second);
+        const AnnouncementType *depref = all_anns->depref(it);
+        if (depref != NULL) {
+            depref_os << asn << ',';
+            to_csv(depref_os, *depref);
+        }
     }
     return os;
 }
 
 template <class AnnouncementType>
 std::ostream& BaseAS<AnnouncementType>::stream_depref(std::ostream &os) {
-    if(depref_anns != NULL) {
-        for (auto &ann : *depref_anns) {
-            os << asn << ',';
-            ann.second.to_csv(os);
+    if(all_anns->stores_depref()) {
+        for (auto it = all_anns->begin(); it != all_anns->end(); ++it) {
+            const AnnouncementType *depref = all_anns->depref(it);
+            if (depref != NULL) {
+                os << asn << ',';
+                to_csv(os, *depref);
+            }
         }
     }
     return os;
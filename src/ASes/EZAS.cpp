@@ -8,10 +8,10 @@ void EZAS::process_announcement(EZAnnouncement &ann, bool ran) {
     //Paths with attackers are the only paths that need to be recorded
     if(ann.from_attacker) {
         //Don't accept if already on the path
-        if(std::find(ann.as_path.begin(), ann.as_path.end(), asn) != ann.as_path.end())
+        if(PathTable::getInstance().contains(ann.path_id, asn))
             return;
 
-        ann.as_path.insert(ann.as_path.begin(), asn);
+        ann.path_id = PathTable::getInstance().extend(ann.path_id, asn);
     }
 
     BaseAS::process_announcement(ann, ran);
@@ -67,14 +67,13 @@ bool ROVppAS::pass_rov(ROVppAnnouncement &ann) {
 }
 
 bool ROVppAS::pass_aspa(ROVppAnnouncement &ann) {
-    bool skiporigin = true;
-    for (auto asn : ann.as_path) {
+    const PathTable &paths = PathTable::getInstance();
+    // Walk back from the last hop, stopping short of the root
+    for (uint32_t path = ann.path_id;
+         path != PathTable::EMPTY_PATH && paths.parent(path) != PathTable::EMPTY_PATH;
+         path = paths.parent(path)) {
         // skip origin---this will be caught by ROV policies
-        if (skiporigin) {
-            skiporigin = false;
-            continue;
-        }
-        if (attackers->find(asn) != attackers->end()) {
+        if (attackers->find(paths.asn(path)) != attackers->end()) {
             return false;
         }
     }
@@ -91,17 +90,17 @@ void ROVppAS::withdraw(ROVppAnnouncement &ann) {
 void ROVppAS::process_announcement(ROVppAnnouncement &ann, bool ran) {
 
     // Check for existing rovannouncement for prefix
-    auto search = loc_rib->find(ann.prefix);
+    auto search = loc_rib->find(ann.prefix_id);
     
     // No rovannouncement found for incoming rovannouncement prefix
     if (search == loc_rib->end()) {
-        loc_rib->insert(std::pair<Prefix<>, ROVppAnnouncement>(ann.prefix, ann));
+        loc_rib->insert(std::pair<uint32_t, ROVppAnnouncement>(ann.prefix_id, ann));
         // Inverse results need to be computed also with announcements from monitors
         if (inverse_results != NULL) {
             auto set = inverse_results->find(
-                std::pair<Prefix<>,uint32_t>(ann.prefix, ann.origin));
+                std::pair<uint32_t, uint32_t>(ann.prefix_id, ann.origin));
             if (set != inverse_results->end()) {
-                set->second->erase(asn);
+                set->second->reset(non_stub_index);
             }
         }
     // Tiebraker for equal priority between old and new ann (but not if they're the same ann)
@@ -116,55 +115,34 @@ void ROVppAS::process_announcement(ROVppAnnouncement &ann, bool ran) {
             if(inverse_results != NULL) {
                 // Update inverse results
                 swap_inverse_result(
-                    std::pair<Prefix<>, uint32_t>(search->second.prefix, search->second.origin),
-                    std::pair<Prefix<>, uint32_t>(ann.prefix, ann.origin));
+                    std::pair<uint32_t, uint32_t>(search->second.prefix_id, search->second.origin),
+                    std::pair<uint32_t, uint32_t>(ann.prefix_id, ann.origin));
             }
 
-            if(depref_anns != NULL) {
-                auto search_depref = depref_anns->find(ann.prefix);
+            if(loc_rib->stores_depref()) {
                 // Use the new rovannouncement and record it won the tiebreak
-                if (search_depref == depref_anns->end()) {
-                    // Insert depref ann
-                    depref_anns->insert(std::pair<Prefix<>, ROVppAnnouncement>(search->second.prefix, 
-                                                                                search->second));
-                } else {
-                    search_depref->second = search->second;
-                }
+                loc_rib->set_depref(search, search->second);
             }
 
             withdraw(search->second);
             search->second = ann;
             check_preventives(search->second);
-        } else if(depref_anns != NULL) {
-            auto search_depref = depref_anns->find(ann.prefix);
-            // Use the old rovannouncement
-            if (search_depref == depref_anns->end()) {
-                depref_anns->insert(std::pair<Prefix<>, ROVppAnnouncement>(ann.prefix, 
-                                                                            ann));
-            } else {
-                // Replace second best with the old priority rovannouncement
-                search_depref->second = ann;
-            }
+        } else if(loc_rib->stores_depref()) {
+            // Use the old rovannouncement, the new one becomes second best
+            loc_rib->set_depref(search, ann);
         }
     // Otherwise check new announcements priority for best path selection
     } else if (ann.priority > search->second.priority) {
         if(inverse_results != NULL) {
             // Update inverse results
             swap_inverse_result(
-                std::pair<Prefix<>, uint32_t>(search->second.prefix, search->second.origin),
-                std::pair<Prefix<>, uint32_t>(ann.prefix, ann.origin));
+                std::pair<uint32_t, uint32_t>(search->second.prefix_id, search->second.origin),
+                std::pair<uint32_t, uint32_t>(ann.prefix_id, ann.origin));
         }
 
-        if(depref_anns != NULL) {
-            auto search_depref = depref_anns->find(ann.prefix);
-            if (search_depref == depref_anns->end()) {
-                // Insert new second best rovannouncement
-                depref_anns->insert(std::pair<Prefix<>, ROVppAnnouncement>(search->second.prefix, 
-                                                                            search->second));
-            } else {
-                // Replace second best with the old priority rovannouncement
-                search_depref->second = search->second;
-            }
+        if(loc_rib->stores_depref()) {
+            // Replace second best with the old priority rovannouncement
+            loc_rib->set_depref(search, search->second);
         }
 
         // Replace the old rovannouncement with the higher priority
@@ -172,14 +150,11 @@ void ROVppAS::process_announcement(ROVppAnnouncement &ann, bool ran) {
         search->second = ann;
         check_preventives(search->second);
     // Old rovannouncement was better
-    } else if(depref_anns != NULL) {
-        auto search_depref = depref_anns->find(ann.prefix);
-        if (search_depref == depref_anns->end()) {
-            // Insert new second best annoucement
-            depref_anns->insert(std::pair<Prefix<>, ROVppAnnouncement>(ann.prefix, ann));
-        } else if (ann.priority > search_depref->second.priority) {
+    } else if(loc_rib->stores_depref()) {
+        ROVppAnnouncement *depref = loc_rib->depref(search);
+        if (depref == NULL || ann.priority > depref->priority) {
             // Replace the old depref rovannouncement with the higher priority
-            search_depref->second = search->second;
+            loc_rib->set_depref(search, ann);
         }
     }
 }
@@ -187,15 +162,9 @@ void ROVppAS::process_announcement(ROVppAnnouncement &ann, bool ran) {
 void ROVppAS::process_announcements(bool ran) {
     // Filter ribs_in for loops, checking path for self
     for (auto it = ribs_in->begin(); it != ribs_in->end();) {
-        bool deleted = false;
-        for (uint32_t a : it->as_path) {
-            if (a == asn && it->origin != asn) {
-                it = ribs_in->erase(it);
-                deleted = true;
-                break;
-            }
-        }
-        if (!deleted) {
+        if (it->origin != asn && PathTable::getInstance().contains(it->path_id, asn)) {
+            it = ribs_in->erase(it);
+        } else {
             ++it;
         }
     }
@@ -223,7 +192,7 @@ void ROVppAS::process_announcements(bool ran) {
                     }
                 }
                 if (should_cancel) {
-                    auto search = loc_rib->find(it->prefix);
+                    auto search = loc_rib->find(it->prefix_id);
                     // Process withdrawal if it applies to loc_rib
                     if (search != loc_rib->end() && search->second == *it) {
                         withdraw(search->second);
@@ -232,7 +201,7 @@ void ROVppAS::process_announcements(bool ran) {
                         if (search->second != best_alternative_ann) {
                             search->second = best_alternative_ann;
                         } else {
-                            loc_rib->erase(it->prefix);    
+                            loc_rib->erase(it->prefix_id);    
                         }
                         ROVppAS::graph_changed = true;  // This means we will need to do another propagation
                     }
@@ -265,7 +234,7 @@ void ROVppAS::process_announcements(bool ran) {
     
     // Process the ribs_in
     for (auto &ann : *ribs_in) {
-        auto search = loc_rib->find(ann.prefix);
+        auto search = loc_rib->find(ann.prefix_id);
         // TODO Remove this?
         // Withdrawals should be processed already above
         // Process withdrawals, regardless of policy
@@ -277,7 +246,7 @@ void ROVppAS::process_announcements(bool ran) {
                 if (search->second != best_alternative_ann) {
                     search->second = best_alternative_ann;
                 } else {
-                    loc_rib->erase(ann.prefix);    
+                    loc_rib->erase(ann.prefix_id);    
                 }
                 ROVppAS::graph_changed = true;  // This means we will need to do another propagation
                 
@@ -291,7 +260,7 @@ void ROVppAS::process_announcements(bool ran) {
             // drop it
             if (ann.origin == asn && attackers->find(asn) == attackers->end()) { continue; }
             for (auto rib_ann : *loc_rib) {
-                if (ann.prefix.contained_in_or_equal_to(rib_ann.second.prefix) &&
+                if (ann.prefix().contained_in_or_equal_to(rib_ann.second.prefix()) &&
                     rib_ann.second.origin == asn &&
                     attackers->find(asn) == attackers->end()) {
                     ann.received_from_asn=64514;
@@ -440,7 +409,7 @@ void ROVppAS::process_announcements(bool ran) {
                             process_announcement(best_alternative_ann, false);
                             // Make preventive rovannouncement
                             ROVppAnnouncement preventive_ann = best_alternative_ann;
-                            preventive_ann.prefix = ann.prefix;
+                            preventive_ann.prefix_id = ann.prefix_id;
                             preventive_ann.alt = best_alternative_ann.received_from_asn;
                             if (preventive_ann.origin == asn) { preventive_ann.received_from_asn=64514; }
                             preventive_anns->insert(std::pair<ROVppAnnouncement,ROVppAnnouncement>(preventive_ann, best_alternative_ann));
@@ -494,11 +463,11 @@ ROVppAnnouncement ROVppAS::best_alternative_route(ROVppAnnouncement &ann) {
      // Find the best alternative to ann
      for (auto &candidate : candidates) {
          // Is there a valid alternative?
-         if (ann.prefix.contained_in_or_equal_to(candidate.prefix)) {
+         if (ann.prefix().contained_in_or_equal_to(candidate.prefix())) {
              // Is the candidate safe?
              bool safe = true;
              for (auto &curr_bad_ann : baddies) {
-                 if (curr_bad_ann.prefix.contained_in_or_equal_to(candidate.prefix) &&
+                 if (curr_bad_ann.prefix().contained_in_or_equal_to(candidate.prefix()) &&
                      curr_bad_ann.received_from_asn == candidate.received_from_asn) {
                      // Well yes, but actually no
                      safe = false;
@@ -523,19 +492,20 @@ void ROVppAS::check_preventives(ROVppAnnouncement ann) {
     // ROV++ V0.3
     if (policy_vector.size() > 0 && policy_vector.at(0) == ROVPPAS_TYPE_ROVPPBP) {
         // note this only works for /24...
-        if (ann.prefix.netmask == 0xffffff00) {
+        const Prefix<> &prefix = ann.prefix();
+        if (prefix.netmask == 0xffffff00) {
             // this is already a preventive
             return;
         }
-        ann.prefix.netmask = 0xffffff00;
+        ann.prefix_id = PrefixTable::getInstance().intern(Prefix<>(prefix.addr, 0xffffff00));
         // find the preventive ann if it exists
-        auto search = loc_rib->find(ann.prefix);
+        auto search = loc_rib->find(ann.prefix_id);
         if (search != loc_rib->end()) {
             ROVppAnnouncement best_alternative_ann = best_alternative_route(search->second); 
             if (ann.received_from_asn == search->second.received_from_asn) {
                 // Remove and attempt to replace the preventive ann
                 withdrawals->push_back(ann);
-                loc_rib->erase(ann.prefix);    
+                loc_rib->erase(ann.prefix_id);    
                 ann.withdraw = false;
                 // replace
                 if (best_alternative_route(ann) == ann) { // If no alternative
@@ -547,7 +517,7 @@ void ROVppAS::check_preventives(ROVppAnnouncement ann) {
                 } else {
                     // Make preventive rovannouncement
                     ROVppAnnouncement preventive_ann = best_alternative_ann;
-                    preventive_ann.prefix = ann.prefix;
+                    preventive_ann.prefix_id = ann.prefix_id;
                     preventive_ann.alt = best_alternative_ann.received_from_asn;
                     if (preventive_ann.origin == asn) { preventive_ann.received_from_asn=64514; }
                     preventive_anns->insert(std::pair<ROVppAnnouncement,ROVppAnnouncement>(preventive_ann, best_alternative_ann));
@@ -566,7 +536,7 @@ void ROVppAS::receive_announcements(std::vector<ROVppAnnouncement> &announcement
 }
 
 bool ROVppAS::already_received(ROVppAnnouncement &ann) {
-    auto search = loc_rib->find(ann.prefix);
+    auto search = loc_rib->find(ann.prefix_id);
     bool found = (search == loc_rib->end()) ? false : true;
     return found;
 }
@@ -574,9 +544,6 @@ bool ROVppAS::already_received(ROVppAnnouncement &ann) {
 void ROVppAS::clear_announcements() {
     loc_rib->clear();
     ribs_in->clear();
-
-    if(depref_anns != NULL)
-        depref_anns->clear();
 }
 
 uint8_t ROVppAS::tiny_hash(uint32_t as_number) {
@@ -592,7 +559,7 @@ uint8_t ROVppAS::tiny_hash(uint32_t as_number) {
 std::ostream& ROVppAS::stream_blackholes(std:: ostream &os) {
   for (ROVppAnnouncement ann : *blackholes) {
       os << asn << ",";
-      ann.to_blackholes_csv(os);
+      to_blackholes_csv(os, ann);
   }
   return os;
 }
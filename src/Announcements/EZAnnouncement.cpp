@@ -4,15 +4,24 @@ EZAnnouncement::EZAnnouncement(uint32_t aorigin, uint32_t aprefix, uint32_t anet
     uint32_t from_asn, int64_t timestamp /* = 0 */, bool from_attacker /* = false */) : Announcement(aorigin, aprefix, anetmask, from_asn, timestamp) {
 
     this->from_attacker = from_attacker;
+    this->path_id = PathTable::EMPTY_PATH;
 }
 
 EZAnnouncement::EZAnnouncement(uint32_t aorigin, uint32_t aprefix, uint32_t anetmask,
     uint32_t pr, uint32_t from_asn, int64_t timestamp, bool a_from_monitor /* = false */, bool from_attacker /* = false */) : Announcement(aorigin, aprefix, anetmask, pr, from_asn, timestamp, a_from_monitor) {
 
     this->from_attacker = from_attacker;
+    this->path_id = PathTable::EMPTY_PATH;
+}
+
+EZAnnouncement::EZAnnouncement(uint32_t aorigin, const Prefix<unsigned __int128> &aprefix,
+    uint32_t pr, uint32_t from_asn, int64_t timestamp, bool a_from_monitor /* = false */, bool from_attacker /* = false */) : Announcement(aorigin, aprefix, pr, from_asn, timestamp, a_from_monitor) {
+
+    this->from_attacker = from_attacker;
+    this->path_id = PathTable::EMPTY_PATH;
 }
 
 EZAnnouncement::EZAnnouncement(const EZAnnouncement& ann) : Announcement(ann) {
     this->from_attacker = ann.from_attacker;
-    this->as_path = ann.as_path;
+    this->path_id = ann.path_id;
 }
\ No newline at end of file
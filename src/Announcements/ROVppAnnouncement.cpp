@@ -33,6 +33,7 @@ ROVppAnnouncement::ROVppAnnouncement(uint32_t aorigin,
     tiebreak_override = 0;
     sent_to_asn = 0;
     withdraw = false;
+    path_id = PathTable::EMPTY_PATH;
 }
 
 /** Priority constructor
@@ -49,7 +50,7 @@ ROVppAnnouncement::ROVppAnnouncement(uint32_t aorigin,
     
     priority = pr; 
     from_monitor = a_from_monitor;
-    as_path = path;
+    path_id = PathTable::getInstance().intern(path);
 }
 
 ROVppAnnouncement::ROVppAnnouncement(uint32_t aorigin, 
@@ -73,8 +74,7 @@ ROVppAnnouncement::ROVppAnnouncement(const ROVppAnnouncement& ann) : Announcemen
     tiebreak_override = ann.tiebreak_override;
     sent_to_asn = ann.sent_to_asn;       
     withdraw =  ann.withdraw;              
-    // this is the important part
-    as_path = ann.as_path; 
+    path_id = ann.path_id;
 }
 
 /** Copy assignment
@@ -89,19 +89,23 @@ ROVppAnnouncement& ROVppAnnouncement::operator=(ROVppAnnouncement ann) {
 /** Swap
  */
 void swap(ROVppAnnouncement& a, ROVppAnnouncement& b) {
-    std::swap(a.prefix, b.prefix);
+    std::swap(a.prefix_id, b.prefix_id);
     std::swap(a.origin, b.origin);
-    std::swap(a.priority, b.priority);
+    // Bit-fields cannot bind to std::swap
+    uint16_t priority = a.priority;
+    a.priority = b.priority;
+    b.priority = priority;
     std::swap(a.received_from_asn, b.received_from_asn);
-    std::swap(a.from_monitor, b.from_monitor);
+    bool from_monitor = a.from_monitor;
+    a.from_monitor = b.from_monitor;
+    b.from_monitor = from_monitor;
     std::swap(a.tstamp, b.tstamp);
     std::swap(a.alt, b.alt);
     std::swap(a.policy_index, b.policy_index);
     std::swap(a.tiebreak_override, b.tiebreak_override);
     std::swap(a.sent_to_asn, b.sent_to_asn);
     std::swap(a.withdraw, b.withdraw);
-    a.as_path.resize(b.as_path.size());
-    std::swap(a.as_path, b.as_path);
+    std::swap(a.path_id, b.path_id);
 }
 
 /** Defines the << operator for the Announcements
@@ -113,46 +117,35 @@ void swap(ROVppAnnouncement& a, ROVppAnnouncement& b) {
  * @return The output stream parameter for reuse/recursion.
  */ 
 std::ostream& operator<<(std::ostream &os, const ROVppAnnouncement& ann) {
-    os << "Prefix:\t\t" << std::hex << ann.prefix.addr << " & " << std::hex << 
-        ann.prefix.netmask << std::endl << "Origin:\t\t" << std::dec << ann.origin
+    os << "Prefix:\t\t" << std::hex << ann.prefix().addr << " & " << std::hex << 
+        ann.prefix().netmask << std::endl << "Origin:\t\t" << std::dec << ann.origin
         << std::endl << "Priority:\t" << ann.priority << std::endl 
         << "Recv'd from:\t" << std::dec << ann.received_from_asn << std::endl
         << "Sent to:\t" << std::dec << ann.sent_to_asn << std::endl
         << "Alt:\t\t" << std::dec << ann.alt << std::endl
         << "TieBrk:\t\t" << std::dec << ann.tiebreak_override << std::endl
-        << "From Monitor:\t" << std::boolalpha << ann.from_monitor << std::endl
+        << "From Monitor:\t" << std::boolalpha << static_cast<bool>(ann.from_monitor) << std::endl
         << "Withdraw:\t" << std::boolalpha << ann.withdraw << std::endl
         << "AS_PATH\t";
-        for (auto i : ann.as_path) { os << i << ' '; }
+        for (auto i : ann.as_path()) { os << i << ' '; }
         os << std::endl;
     return os;
 }
 
-/** Passes the announcement struct data to an output stream to csv generation.
- *
- * @param &os Specifies the output stream.
- * @return The output stream parameter for reuse/recursion.
- */ 
-std::ostream& ROVppAnnouncement::to_csv(std::ostream &os) {
-    os << prefix.to_cidr() << ',' << origin << ',' << received_from_asn << ',' << tstamp << ',' << alt << '\n';
+std::ostream& to_csv(std::ostream &os, const ROVppAnnouncement &ann) {
+    os << PrefixTable::getInstance().cidr(ann.prefix_id) << ',' << ann.origin << ',' << ann.received_from_asn << ',' << ann.tstamp << ',' << ann.alt << '\n';
     return os;
 }
 
-/** Passes the announcement struct data to an output stream to csv generation.
- * For creating the rovpp_blackholes table only.
- * 
- * @param &os Specifies the output stream.
- * @return The output stream parameter for reuse/recursion.
- */ 
-std::ostream& ROVppAnnouncement::to_blackholes_csv(std::ostream &os) {
-    os << prefix.to_cidr() << ',' << origin << ',' << received_from_asn << ',' << tstamp << '\n';
+std::ostream& to_blackholes_csv(std::ostream &os, const ROVppAnnouncement &ann) {
+    os << PrefixTable::getInstance().cidr(ann.prefix_id) << ',' << ann.origin << ',' << ann.received_from_asn << ',' << ann.tstamp << '\n';
     return os;
 }
 
 bool ROVppAnnouncement::operator==(const ROVppAnnouncement &b) const {
     return (origin == b.origin) &&
-            (prefix == b.prefix) &&
-            (as_path == b.as_path) &&
+            (prefix_id == b.prefix_id) &&
+            (path_id == b.path_id) &&
             (priority == b.priority) &&
             (sent_to_asn == b.sent_to_asn) &&
             (alt == b.alt) &&
@@ -165,7 +158,7 @@ bool ROVppAnnouncement::operator!=(const ROVppAnnouncement &b) const {
 
 bool ROVppAnnouncement::operator<(const ROVppAnnouncement &b) const {
     return (origin < b.origin) ||
-            (prefix < b.prefix) ||
+            (prefix() < b.prefix()) ||
             (priority < b.priority) ||
             (sent_to_asn < b.sent_to_asn) ||
             (received_from_asn < b.received_from_asn) ||
@@ -0,0 +1,134 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <algorithm>
+
+#include "Arena.h"
+
+const size_t Arena::DEFAULT_CHUNK_SIZE;
+
+static std::atomic<uint64_t> next_arena_id(1);
+
+/** Region a thread bumps through in one arena.
+ */
+struct ThreadRegion {
+    uint64_t arena_id;
+    uint64_t generation;
+    char *cur;
+    char *end;
+};
+
+// A thread may fill the arenas of a few graph workspaces, so it keeps one
+// region for each of the last few arenas it allocated from
+static const size_t THREAD_REGIONS = 4;
+static thread_local ThreadRegion thread_regions[THREAD_REGIONS];
+static thread_local size_t next_thread_region = 0;
+
+Arena::Arena(size_t chunk_size) : id(next_arena_id++), generation(0) {
+    this->chunk_size = chunk_size;
+    claimed = 0;
+    used = 0;
+    high_water = 0;
+    reserved = 0;
+}
+
+Arena::~Arena() {
+    for (Chunk &chunk : chunks)
+        ::operator delete(chunk.data);
+}
+
+void *Arena::allocate(size_t bytes, size_t alignment) {
+    uint64_t gen = generation.load(std::memory_order_acquire);
+    ThreadRegion *region = NULL;
+    for (ThreadRegion &r : thread_regions) {
+        if (r.arena_id == id) {
+            region = &r;
+            break;
+        }
+    }
+    if (region != NULL && region->generation == gen) {
+        // Chunks come from operator new, so aligning the address within one keeps it aligned
+        uintptr_t start = (reinterpret_cast<uintptr_t>(region->cur) + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        if (start + bytes <= reinterpret_cast<uintptr_t>(region->end)) {
+            region->cur = reinterpret_cast<char*>(start + bytes);
+            return reinterpret_cast<char*>(start);
+        }
+    }
+
+    // Out of room, the tail of the old region stays unused until reset
+    if (region == NULL) {
+        region = &thread_regions[next_thread_region];
+        next_thread_region = (next_thread_region + 1) % THREAD_REGIONS;
+    }
+    Chunk chunk = claim_region(bytes, alignment);
+    region->arena_id = id;
+    region->generation = gen;
+    uintptr_t start = (reinterpret_cast<uintptr_t>(chunk.data) + alignment - 1) & ~(uintptr_t) (alignment - 1);
+    region->cur = reinterpret_cast<char*>(start + bytes);
+    region->end = chunk.data + chunk.size;
+    return reinterpret_cast<char*>(start);
+}
+
+Arena::Chunk Arena::claim_region(size_t bytes, size_t alignment) {
+    std::lock_guard<std::mutex> guard(lock);
+    // Reuse the chunks kept from earlier blocks, skipping those too small
+    while (claimed < chunks.size()) {
+        Chunk chunk = chunks[claimed++];
+        used += chunk.size;
+        if (bytes + alignment <= chunk.size) {
+            high_water = std::max(high_water, used);
+            return chunk;
+        }
+    }
+    Chunk chunk;
+    chunk.size = std::max(chunk_size, bytes + alignment);
+    chunk.data = static_cast<char*>(::operator new(chunk.size));
+    chunks.push_back(chunk);
+    claimed++;
+    used += chunk.size;
+    reserved += chunk.size;
+    high_water = std::max(high_water, used);
+    return chunk;
+}
+
+void Arena::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    claimed = 0;
+    used = 0;
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+size_t Arena::bytes_in_use() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return used;
+}
+
+size_t Arena::high_water_mark() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return high_water;
+}
+
+size_t Arena::bytes_reserved() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return reserved;
+}
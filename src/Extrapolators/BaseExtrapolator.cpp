@@ -43,30 +43,40 @@ BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::~BaseExtr
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 std::vector<uint32_t>* BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::parse_path(std::string path_as_string) {
     std::vector<uint32_t> *as_path = new std::vector<uint32_t>;
-    // Remove brackets from string
-    path_as_string.erase(std::find(path_as_string.begin(), path_as_string.end(), '}'));
-    path_as_string.erase(std::find(path_as_string.begin(), path_as_string.end(), '{'));
+    parse_path(path_as_string.c_str(), *as_path);
+    return as_path;
+}
 
-    // Fill as_path vector from parsing string
-    std::string delimiter = ",";
-    std::string::size_type pos = 0;
-    std::string token;
-    while ((pos = path_as_string.find(delimiter)) != std::string::npos) {
-        token = path_as_string.substr(0,pos);
-        try {
-            as_path->push_back(std::stoul(token));
-        } catch(...) {
-            std::cerr << "Parse path error, token was: " << token << std::endl;
-        }
-        path_as_string.erase(0,pos + delimiter.length());
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::parse_path(const char *path_as_string, std::vector<uint32_t> &as_path) {
+    as_path.clear();
+    const char *p = path_as_string;
+    // Skip the opening bracket
+    if (*p == '{') {
+        p++;
     }
-    // Handle last ASN after loop
-    try {
-        as_path->push_back(std::stoul(path_as_string));
-    } catch(...) {
-        std::cerr << "Parse path error, token was: " << path_as_string << std::endl;
+    while (*p != '\0' && *p != '}') {
+        const char *token = p;
+        uint64_t asn = 0;
+        while (*p >= '0' && *p <= '9' && asn <= UINT32_MAX) {
+            asn = asn * 10 + (*p - '0');
+            p++;
+        }
+        bool valid = p != token && asn <= UINT32_MAX;
+        // Find the end of the token so a bad one can be reported and skipped
+        while (*p != '\0' && *p != ',' && *p != '}') {
+            valid = false;
+            p++;
+        }
+        if (valid) {
+            as_path.push_back(static_cast<uint32_t>(asn));
+        } else {
+            std::cerr << "Parse path error, token was: " << std::string(token, p - token) << std::endl;
+        }
+        if (*p == ',') {
+            p++;
+        }
     }
-    return as_path;
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
@@ -89,23 +99,23 @@ void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::prop
     size_t levels = graph->ases_by_rank->size();
     // Propagate to providers
     for (size_t level = 0; level < levels; level++) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(random_tiebraking);
-            bool is_empty = search->second->all_anns->empty();
+        for (uint32_t id : *graph->ases_by_rank->at(level)) {
+            ASType *as = (*graph->ases_by_id)[id];
+            as->process_announcements(random_tiebraking);
+            bool is_empty = as->all_anns->empty();
             if (!is_empty) {
-                send_all_announcements(asn, true, false, false);
+                send_all_announcements(as, true, false, false);
             }
         }
     }
     // Propagate to peers
     for (size_t level = 0; level < levels; level++) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(random_tiebraking);
-            bool is_empty = search->second->all_anns->empty();
+        for (uint32_t id : *graph->ases_by_rank->at(level)) {
+            ASType *as = (*graph->ases_by_id)[id];
+            as->process_announcements(random_tiebraking);
+            bool is_empty = as->all_anns->empty();
             if (!is_empty) {
-                send_all_announcements(asn, false, true, false);
+                send_all_announcements(as, false, true, false);
             }
         }
     }
@@ -115,58 +125,93 @@ void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::prop
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_down() {
     size_t levels = graph->ases_by_rank->size();
-    for (size_t level = levels-1; level-- > 0;) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(random_tiebraking);
-            bool is_empty = search->second->all_anns->empty();
+    for (size_t level = levels; level-- > 0;) {
+        for (uint32_t id : *graph->ases_by_rank->at(level)) {
+            ASType *as = (*graph->ases_by_id)[id];
+            as->process_announcements(random_tiebraking);
+            bool is_empty = as->all_anns->empty();
             if (!is_empty) {
-                send_all_announcements(asn, false, false, true);
+                send_all_announcements(as, false, false, true);
             }
         }
     }
 }
 
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::send_all_announcements(uint32_t asn, 
+                                                                                                     bool to_providers, 
+                                                                                                     bool to_peers, 
+                                                                                                     bool to_customers) {
+    send_all_announcements(graph->ases->find(asn)->second, to_providers, to_peers, to_customers);
+}
+
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results(int iteration){
+    write_results(iteration);
+    copy_results(iteration);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::write_results(int iteration){
     std::ofstream outfile;
     std::string file_name = "/dev/shm/bgp/" + std::to_string(iteration) + ".csv";
     outfile.open(file_name);
+
+    // Depref routes live next to the best routes, so they are written in the same pass
+    std::ofstream depref_outfile;
+    std::string depref_name = "/dev/shm/bgp/depref" + std::to_string(iteration) + ".csv";
+    if (store_depref_results) {
+        depref_outfile.open(depref_name);
+        std::cout << "Saving Depref From Iteration: " << iteration << std::endl;
+    }
     
     // Handle inverse results
     if (store_invert_results) {
         std::cout << "Saving Inverse Results From Iteration: " << iteration << std::endl;
         for (auto po : *graph->inverse_results){
-            for (uint32_t asn : *po.second) {
-                outfile << asn << ','
-                        << po.first.first.to_cidr() << ','
+            const std::string &cidr = PrefixTable::getInstance().cidr(po.first.first);
+            po.second->for_each([&](uint32_t index) {
+                outfile << graph->non_stubs->at(index) << ','
+                        << cidr << ','
                         << po.first.second << '\n';
+            });
+        }
+        if (store_depref_results) {
+            for (auto &as : *graph->ases) {
+                as.second->stream_depref(depref_outfile);
             }
         }
-        outfile.close();
-        querier->copy_inverse_results_to_db(file_name);
     
     // Handle standard results
     } else {
         std::cout << "Saving Results From Iteration: " << iteration << std::endl;
         for (auto &as : *graph->ases){
-            as.second->stream_announcements(outfile);
+            if (store_depref_results) {
+                as.second->stream_announcements(outfile, depref_outfile);
+            } else {
+                as.second->stream_announcements(outfile);
+            }
         }
-        outfile.close();
-        querier->copy_results_to_db(file_name);
+    }
+    outfile.close();
+    if (store_depref_results) {
+        depref_outfile.close();
+    }
+}
 
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::copy_results(int iteration){
+    std::string file_name = "/dev/shm/bgp/" + std::to_string(iteration) + ".csv";
+    if (store_invert_results) {
+        querier->copy_inverse_results_to_db(file_name);
+    } else {
+        querier->copy_results_to_db(file_name);
     }
     std::remove(file_name.c_str());
     
     // Handle depref results
     if (store_depref_results) {
         std::string depref_name = "/dev/shm/bgp/depref" + std::to_string(iteration) + ".csv";
-        outfile.open(depref_name);
-        std::cout << "Saving Depref From Iteration: " << iteration << std::endl;
-        for (auto &as : *graph->ases) {
-            as.second->stream_depref(outfile);
-        }
-        outfile.close();
         querier->copy_depref_to_db(depref_name);
         std::remove(depref_name.c_str());
     }
@@ -2,7 +2,13 @@
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::~BlockedExtrapolator() {
-
+    // Before the graph whose topology they share
+    stop_workers();
+    delete pool;
+    delete queued;
+    delete frontier;
+    delete touched_bits;
+    delete touched;
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
@@ -16,6 +22,16 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::i
     }
 
     // Generate required tables
+    this->querier->clear_stubs_from_db();
+    this->querier->create_stubs_tbl();
+    this->querier->clear_non_stubs_from_db();
+    this->querier->create_non_stubs_tbl();
+    this->querier->clear_supernodes_from_db();
+    this->querier->create_supernodes_tbl();
+    
+    // Throws when the relationships cannot be read, so the previous results survive
+    build_graph();
+
     if (this->store_invert_results) {
         this->querier->clear_inverse_from_db();
         this->querier->create_inverse_results_tbl();
@@ -28,16 +44,15 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::i
         this->querier->clear_depref_from_db();
         this->querier->create_depref_tbl();
     }
+}
 
-    this->querier->clear_stubs_from_db();
-    this->querier->create_stubs_tbl();
-    this->querier->clear_non_stubs_from_db();
-    this->querier->create_non_stubs_tbl();
-    this->querier->clear_supernodes_from_db();
-    this->querier->create_supernodes_tbl();
-    
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::build_graph() {
     // Generate the graph and populate the stubs & supernode tables
-    this->graph->create_graph_from_db(this->querier);
+    if (!as_rel_file.empty())
+        this->graph->create_graph_from_file(as_rel_file, this->querier);
+    else
+        this->graph->create_graph_from_db(this->querier);
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
@@ -53,15 +68,37 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::p
     this->populate_blocks(cur_prefix, prefix_blocks, subnet_blocks); // Select blocks based on iteration size
     delete cur_prefix;
 
-    extrapolate(prefix_blocks, subnet_blocks);
+    // IPv6 blocks are scheduled separately, starting at ::/0
+    std::vector<Prefix<unsigned __int128>*> *prefix_blocks6 = new std::vector<Prefix<unsigned __int128>*>;
+    std::vector<Prefix<unsigned __int128>*> *subnet_blocks6 = new std::vector<Prefix<unsigned __int128>*>;
+    if (ipv6) {
+        Prefix<unsigned __int128> *cur_prefix6 = new Prefix<unsigned __int128>("::", "::");
+        this->populate_blocks(cur_prefix6, prefix_blocks6, subnet_blocks6);
+        delete cur_prefix6;
+    }
+
+    extrapolate(prefix_blocks, subnet_blocks, prefix_blocks6, subnet_blocks6);
     
     // Cleanup
+    for (Prefix<>* p : *prefix_blocks)
+        delete p;
+    for (Prefix<>* p : *subnet_blocks)
+        delete p;
+    for (Prefix<unsigned __int128>* p : *prefix_blocks6)
+        delete p;
+    for (Prefix<unsigned __int128>* p : *subnet_blocks6)
+        delete p;
     delete prefix_blocks;
     delete subnet_blocks;
+    delete prefix_blocks6;
+    delete subnet_blocks6;
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
-void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::extrapolate(std::vector<Prefix<>*> *prefix_blocks, std::vector<Prefix<>*> *subnet_blocks) {
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::extrapolate(std::vector<Prefix<>*> *prefix_blocks, 
+                                                                                    std::vector<Prefix<>*> *subnet_blocks,
+                                                                                    std::vector<Prefix<unsigned __int128>*> *prefix_blocks6,
+                                                                                    std::vector<Prefix<unsigned __int128>*> *subnet_blocks6) {
     std::cout << "Beginning propagation..." << std::endl;
     
     // Seed MRT announcements and propagate
@@ -75,16 +112,46 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::e
     // For each unprocessed subnet block  
     this->extrapolate_blocks(announcement_count, iteration, true, subnet_blocks);
 
+    // Then the IPv6 blocks, iterations keep counting so result files do not collide
+    if (prefix_blocks6 != NULL)
+        this->extrapolate_blocks(announcement_count, iteration, false, prefix_blocks6);
+    if (subnet_blocks6 != NULL)
+        this->extrapolate_blocks(announcement_count, iteration, true, subnet_blocks6);
+    // Largest block held by any workspace, to size iteration_size by
+    size_t storage_high_water = this->graph->announcement_arena->high_water_mark();
+    if (workers != NULL) {
+        for (auto *worker : *workers)
+            storage_high_water = std::max(storage_high_water, worker->graph->announcement_arena->high_water_mark());
+    }
+    // Release the workers' announcement storage
+    stop_workers();
+
     auto ext_finish = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> e = ext_finish - ext_start;
     std::cout << "Block elapsed time: " << e.count() << std::endl;
     std::cout << "Announcement count: " << announcement_count << std::endl;
+    std::cout << "Announcement storage high-water mark: " << storage_high_water / (1 << 20) << " MiB" << std::endl;
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::populate_blocks(Prefix<>* p,
                                                                             std::vector<Prefix<>*>* prefix_vector,
                                                                             std::vector<Prefix<>*>* bloc_vector) { 
+    populate_family_blocks(p, prefix_vector, bloc_vector);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::populate_blocks(Prefix<unsigned __int128>* p,
+                                                                            std::vector<Prefix<unsigned __int128>*>* prefix_vector,
+                                                                            std::vector<Prefix<unsigned __int128>*>* bloc_vector) { 
+    populate_family_blocks(p, prefix_vector, bloc_vector);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+template <typename Integer>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::populate_family_blocks(Prefix<Integer>* p,
+                                                                                    std::vector<Prefix<Integer>*>* prefix_vector,
+                                                                                    std::vector<Prefix<Integer>*>* bloc_vector) { 
     // Find the number of announcements within the subnet
     pqxx::result r = this->querier->select_subnet_count(p);
     
@@ -93,45 +160,35 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::p
     std::cout << "Count: "<< r[0][0].as<int>() << std::endl;
     */
     
-    // If the subnet count is within size constraint
-    if (r[0][0].as<uint32_t>() < this->iteration_size) {
+    // If the subnet count is within size constraint, or the subnet cannot be split further
+    int sz = p->length();
+    if (r[0][0].as<uint32_t>() < this->iteration_size || sz == Prefix<Integer>::BITS) {
         // Add to subnet block vector
         if (r[0][0].as<uint32_t>() > 0) {
-            Prefix<>* p_copy = new Prefix<>(p->addr, p->netmask);
+            Prefix<Integer>* p_copy = new Prefix<Integer>(p->addr, p->netmask);
             bloc_vector->push_back(p_copy);
         }
     } else {
         // Store the prefix if there are announcements for it specifically
         pqxx::result r2 = this->querier->select_prefix_count(p);
         if (r2[0][0].as<uint32_t>() > 0) {
-            Prefix<>* p_copy = new Prefix<>(p->addr, p->netmask);
+            Prefix<Integer>* p_copy = new Prefix<Integer>(p->addr, p->netmask);
             prefix_vector->push_back(p_copy);
         }
 
         // Split prefix
         // First half: increase the prefix length by 1
-        uint32_t new_mask;
-        if (p->netmask == 0) {
-            new_mask = p->netmask | 0x80000000;
-        } else {
-            new_mask = (p->netmask >> 1) | p->netmask;
-        }
-        Prefix<>* p1 = new Prefix<>(p->addr, new_mask);
+        Integer top_bit = static_cast<Integer>(1) << (Prefix<Integer>::BITS - 1);
+        Integer new_mask = (p->netmask >> 1) | top_bit;
+        Prefix<Integer>* p1 = new Prefix<Integer>(p->addr, new_mask);
         
         // Second half: increase the prefix length by 1 and flip previous length bit
-        int8_t sz = 0;
-        uint32_t new_addr = p->addr;
-        for (int i = 0; i < 32; i++) {
-            if (p->netmask & (1 << i)) {
-                sz++;
-            }
-        }
-        new_addr |= 1UL << (32 - sz - 1);
-        Prefix<>* p2 = new Prefix<>(new_addr, new_mask);
+        Integer new_addr = p->addr | (top_bit >> sz);
+        Prefix<Integer>* p2 = new Prefix<Integer>(new_addr, new_mask);
 
         // Recursive call on each new prefix subnet
-        populate_blocks(p1, prefix_vector, bloc_vector);
-        populate_blocks(p2, prefix_vector, bloc_vector);
+        populate_family_blocks(p1, prefix_vector, bloc_vector);
+        populate_family_blocks(p2, prefix_vector, bloc_vector);
 
         delete p1;
         delete p2;
@@ -143,13 +200,99 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::e
                                                                                                     int &iteration, 
                                                                                                     bool subnet, 
                                                                                                     std::vector<Prefix<>*> *prefix_set) {
+    extrapolate_family_blocks(announcement_count, iteration, subnet, prefix_set);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::extrapolate_blocks(uint32_t &announcement_count, 
+                                                                                                    int &iteration, 
+                                                                                                    bool subnet, 
+                                                                                                    std::vector<Prefix<unsigned __int128>*> *prefix_set) {
+    extrapolate_family_blocks(announcement_count, iteration, subnet, prefix_set);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+template <typename Integer>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::extrapolate_family_blocks(uint32_t &announcement_count, 
+                                                                                                        int &iteration, 
+                                                                                                        bool subnet, 
+                                                                                                        std::vector<Prefix<Integer>*> *prefix_set) {
+    if (block_workers > 1 && prefix_set->size() > 1 && start_workers()) {
+        // Every block has its iteration number decided up front
+        std::atomic<size_t> next(0);
+        std::atomic<uint32_t> count(0);
+        std::vector<std::thread> running;
+        std::vector<std::chrono::steady_clock::time_point> out_of_work(workers->size());
+        for (size_t w = 0; w < workers->size(); w++) {
+            auto *worker = workers->at(w);
+            running.push_back(std::thread([&, worker, w]() {
+                for (size_t i = next++; i < prefix_set->size(); i = next++) {
+                    // Empty blocks are skipped, the others may already be in flight
+                    count += worker->extrapolate_block(prefix_set->at(i), subnet, iteration + i);
+                }
+                out_of_work[w] = std::chrono::steady_clock::now();
+            }));
+        }
+        for (auto &t : running)
+            t.join();
+        // Time each worker waited for the last blocks of the others
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "Idle seconds per block worker:";
+        for (auto &t : out_of_work)
+            std::cout << ' ' << std::chrono::duration<double>(end - t).count();
+        std::cout << std::endl;
+        announcement_count += count;
+        iteration += prefix_set->size();
+        return;
+    }
+
+    if (pipeline_depth > 0) {
+        pipeline_blocks(announcement_count, iteration, subnet, prefix_set);
+        return;
+    }
+
     // For each unprocessed block of announcements 
-    for (Prefix<>* prefix : *prefix_set) {
-        std::cout << "Selecting Announcements..." << std::endl;
-        auto prefix_start = std::chrono::high_resolution_clock::now();
-        
-        // Handle prefix blocks or subnet blocks of announcements
-        pqxx::result ann_block;
+    for (Prefix<Integer>* prefix : *prefix_set) {
+        uint32_t bsize = extrapolate_block(prefix, subnet, iteration);
+        // Skip empty blocks, like the block workers do
+        if (bsize == 0)
+            continue;
+        announcement_count += bsize;
+        iteration++;
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+template <typename Integer>
+uint32_t BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::extrapolate_block(Prefix<Integer> *prefix, 
+                                                                                                       bool subnet, 
+                                                                                                       int iteration) {
+    FetchedBlock<Integer> block;
+    fetch_block(prefix, subnet, block);
+    // Check for empty block
+    if (block.size == 0)
+        return 0;
+    propagate_block(block, iteration);
+    this->copy_results(iteration);
+    return block.size;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+template <typename Integer>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::fetch_block(Prefix<Integer> *prefix, 
+                                                                                             bool subnet, 
+                                                                                             FetchedBlock<Integer> &block,
+                                                                                             std::mutex *db_lock) {
+    std::cout << "Selecting Announcements..." << std::endl;
+    block.prefix = prefix;
+    block.announcements.clear();
+    
+    // Handle prefix blocks or subnet blocks of announcements
+    pqxx::result ann_block;
+    {
+        std::unique_lock<std::mutex> guard;
+        if (db_lock != NULL)
+            guard = std::unique_lock<std::mutex>(*db_lock);
         if (!subnet) {
             // Get the block of announcements for the specific prefix
             ann_block = this->querier->select_prefix_ann(prefix);
@@ -157,75 +300,164 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::e
             // Get the block of announcements for the whole subnet
             ann_block = this->querier->select_subnet_ann(prefix);
         } 
+    }
+    
+    auto bsize = ann_block.size();
+    block.size = bsize;
+    block.announcements.reserve(bsize);
+    // Reused for every row, fields are parsed from their bytes in place
+    std::vector<uint32_t> as_path;
+    // For all announcements in this block
+    for (pqxx::result::size_type i = 0; i < bsize; i++) {
+        // Get row origin
+        uint32_t origin;
+        ann_block[i]["origin"].to(origin);
+        // Get row prefix
+        Prefix<Integer> cur_prefix(ann_block[i]["host"].c_str(), ann_block[i]["netmask"].c_str());
+        // Get row AS path
+        const char *path_as_string = ann_block[i]["as_path"].c_str();
+        this->parse_path(path_as_string, as_path);
         
-        // Check for empty block
-        auto bsize = ann_block.size();
-        if (bsize == 0)
-            break;
-        announcement_count += bsize;
-        
-        std::cout << "Seeding announcements..." << std::endl;
-        // For all announcements in this block
-        for (pqxx::result::size_type i = 0; i < bsize; i++) {
-            // Get row origin
-            uint32_t origin;
-            ann_block[i]["origin"].to(origin);
-            // Get row prefix
-            std::string ip = ann_block[i]["host"].c_str();
-            std::string mask = ann_block[i]["netmask"].c_str();
-            Prefix<> cur_prefix(ip, mask);
-            // Get row AS path
-            std::string path_as_string(ann_block[i]["as_path"].as<std::string>());
-            std::vector<uint32_t> *as_path = this->parse_path(path_as_string);
+        // Check for loops in the path and drop announcement if they exist
+        bool loop = this->find_loop(&as_path);
+        if (loop) {
+            // Shared by the block workers
+            static std::atomic<int> g_loop(1);
             
-            // Check for loops in the path and drop announcement if they exist
-            bool loop = this->find_loop(as_path);
-            if (loop) {
-                static int g_loop = 1;
-                
-                Logger::getInstance().log("Loops") << "AS path loop #" << g_loop << ", Origin: " << origin << ", Prefix: " << cur_prefix.to_cidr() << ", Path: " << path_as_string;
-
-                g_loop++;
-                continue;
-            }
+            Logger::getInstance().log("Loops") << "AS path loop #" << g_loop++ << ", Origin: " << origin << ", Prefix: " << cur_prefix.to_cidr() << ", Path: " << path_as_string;
+            continue;
+        }
 
-            // Get timestamp
-            int64_t timestamp = std::stol(ann_block[i]["time"].as<std::string>());
-
-            if(this->graph->inverse_results != NULL) {
-                // Assemble pair
-                auto prefix_origin = std::pair<Prefix<>, uint32_t>(cur_prefix, origin);
-                
-                // Insert the inverse results for this prefix
-                if (this->graph->inverse_results->find(prefix_origin) == this->graph->inverse_results->end()) {
-                    // This is horrifying
-                    this->graph->inverse_results->insert(std::pair<std::pair<Prefix<>, uint32_t>, 
-                                                            std::set<uint32_t>*>
-                                                            (prefix_origin, new std::set<uint32_t>()));
-                    
-                    // Put all non-stub ASNs in the set
-                    for (uint32_t asn : *this->graph->non_stubs) {
-                        this->graph->inverse_results->find(prefix_origin)->second->insert(asn);
-                    }
-                }
+        // Get timestamp
+        int64_t timestamp = std::strtoll(ann_block[i]["time"].c_str(), NULL, 10);
+
+        block.announcements.push_back(SeedAnnouncement<Integer>());
+        SeedAnnouncement<Integer> &seed = block.announcements.back();
+        seed.origin = origin;
+        seed.prefix = cur_prefix;
+        seed.as_path = as_path;
+        seed.timestamp = timestamp;
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+template <typename Integer>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_block(FetchedBlock<Integer> &block, 
+                                                                                                 int iteration) {
+    std::cout << "Seeding announcements..." << std::endl;
+    auto prefix_start = std::chrono::high_resolution_clock::now();
+    for (auto &seed : block.announcements) {
+        if(this->graph->inverse_results != NULL) {
+            // Assemble pair
+            auto prefix_origin = std::pair<uint32_t, uint32_t>(PrefixTable::getInstance().intern(seed.prefix), seed.origin);
+            
+            // Insert the inverse results for this prefix, starting with all non-stub ASNs
+            if (this->graph->inverse_results->find(prefix_origin) == this->graph->inverse_results->end()) {
+                this->graph->inverse_results->insert(std::pair<std::pair<uint32_t, uint32_t>, ASBitset*>
+                                                        (prefix_origin, new ASBitset(this->graph->non_stubs->size())));
             }
+        }
 
-            // Seed announcements along AS path
-            this->give_ann_to_as_path(as_path, cur_prefix, timestamp);
-            delete as_path;
+        // Seed announcements along AS path
+        this->give_ann_to_as_path(&seed.as_path, seed.prefix, seed.timestamp);
+    }
+    // Propagate for this subnet
+    std::cout << "Propagating..." << std::endl;
+    this->propagate_up();
+    this->propagate_down();
+    if (pool != NULL) {
+        // Time the propagation threads waited on the others in this block
+        std::cout << "Idle seconds per thread:";
+        for (double idle : pool->idle_seconds())
+            std::cout << ' ' << idle;
+        std::cout << std::endl;
+        pool->reset_idle();
+    }
+    this->write_results(iteration);
+    clear_block();
+    
+    std::cout << block.prefix->to_cidr() << " completed." << std::endl;
+    auto prefix_finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> q = prefix_finish - prefix_start;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+template <typename Integer>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::pipeline_blocks(uint32_t &announcement_count, 
+                                                                                                 int &iteration, 
+                                                                                                 bool subnet, 
+                                                                                                 std::vector<Prefix<Integer>*> *prefix_set) {
+    // The querier has a single connection, fetching and copying take turns on it
+    std::mutex db_lock;
+    BoundedQueue<FetchedBlock<Integer>> fetched(pipeline_depth);
+    BoundedQueue<int> written(pipeline_depth);
+
+    std::thread fetch_stage([&]() {
+        for (Prefix<Integer> *prefix : *prefix_set) {
+            FetchedBlock<Integer> block;
+            fetch_block(prefix, subnet, block, &db_lock);
+            // Skip empty blocks, like the block workers do
+            if (block.size == 0)
+                continue;
+            fetched.push(std::move(block));
         }
-        // Propagate for this subnet
-        std::cout << "Propagating..." << std::endl;
-        this->propagate_up();
-        this->propagate_down();
-        this->save_results(iteration);
-        this->graph->clear_announcements();
+        fetched.close();
+    });
+    std::thread save_stage([&]() {
+        int written_iteration;
+        while (written.pop(written_iteration)) {
+            std::lock_guard<std::mutex> guard(db_lock);
+            this->copy_results(written_iteration);
+        }
+    });
+
+    FetchedBlock<Integer> block;
+    while (fetched.pop(block)) {
+        propagate_block(block, iteration);
+        written.push(iteration);
+        announcement_count += block.size;
         iteration++;
-        
-        std::cout << prefix->to_cidr() << " completed." << std::endl;
-        auto prefix_finish = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> q = prefix_finish - prefix_start;
     }
+    written.close();
+    fetch_stage.join();
+    save_stage.join();
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+bool BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::start_workers() {
+    if (workers != NULL && workers->size() == block_workers)
+        return true;
+    stop_workers();
+    workers = new std::vector<BlockedExtrapolator*>;
+    for (uint32_t i = 0; i < block_workers; i++) {
+        BlockedExtrapolator *worker = create_worker();
+        if (worker == NULL) {
+            // Blocks are extrapolated one after another instead
+            stop_workers();
+            return false;
+        }
+        worker->pull_propagation = pull_propagation;
+        worker->threads = threads;
+        worker->sparse_propagation = sparse_propagation;
+        workers->push_back(worker);
+    }
+    return true;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::stop_workers() {
+    if (workers == NULL)
+        return;
+    for (auto *worker : *workers)
+        delete worker;
+    delete workers;
+    workers = NULL;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>* 
+BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::create_worker() {
+    return NULL;
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
@@ -234,31 +466,39 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::g
     if (as_path->empty()) { 
         return;
     }
-    
+    // Intern the prefix once, every hop gets a copy of this seeded announcement
+    seed_as_path(as_path, AnnouncementType(*as_path->rbegin(), prefix.addr, prefix.netmask, 0, 0, timestamp, true), timestamp);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<unsigned __int128> prefix, int64_t timestamp) {
+    // Handle empty as_path
+    if (as_path->empty()) { 
+        return;
+    }
+    seed_as_path(as_path, AnnouncementType(*as_path->rbegin(), prefix, 0, 0, timestamp, true), timestamp);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::seed_as_path(std::vector<uint32_t>* as_path, const AnnouncementType &seeded_ann, int64_t timestamp) {
     uint32_t i = 0;
     uint32_t path_l = as_path->size();
-    
-    // Announcement at origin for checking along the path
-    // AnnouncementType ann_to_check_for(as_path->at(path_l-1),
-    //                                     prefix.addr,
-    //                                     prefix.netmask,
-    //                                     0,
-    //                                     timestamp); 
+    uint32_t prefix_id = seeded_ann.prefix_id;
     
     // Iterate through path starting at the origin
     for (auto it = as_path->rbegin(); it != as_path->rend(); ++it) {
         // Increments path length, including prepending
         i++;
         // If ASN not in graph, continue
-        if (this->graph->ases->find(*it) == this->graph->ases->end()) {
+        // Supernode members and stubs are not in the graph, so no translation is needed
+        auto as_search = this->graph->ases->find(*it);
+        if (as_search == this->graph->ases->end()) {
             continue;
         }
-        // Translate ASN to it's supernode
-        uint32_t asn_on_path = this->graph->translate_asn(*it);
         // Find the current AS on the path
-        ASType *as_on_path = this->graph->ases->find(asn_on_path)->second;
+        ASType *as_on_path = as_search->second;
 
-        auto announcement_search = as_on_path->all_anns->find(prefix);
+        auto announcement_search = as_on_path->all_anns->find(prefix_id);
 
         // Check if already received this prefix
         if (announcement_search != as_on_path->all_anns->end()) {
@@ -277,7 +517,7 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::g
                 }
 
                 // Log annoucements with equal timestamps 
-                Logger::getInstance().log("Equal_Timestamp") << "Equal Timestamp on announcements. Prefix: " << prefix.to_cidr() << 
+                Logger::getInstance().log("Equal_Timestamp") << "Equal Timestamp on announcements. Prefix: " << PrefixTable::getInstance().cidr(prefix_id) << 
                     ", rand value: " << keep_first << ", tstamp on announcements: " << timestamp << 
                     ", origin on ann_to_check_for: " << as_path->at(path_l-1) << ", origin on stored announcement: " << second_announcement.origin;
 
@@ -291,18 +531,18 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::g
                     if (pos < path_l && as_path->at(pos) == as_on_path->asn) {
                         continue;
                     }
-                    as_on_path->delete_ann(prefix);
+                    as_on_path->delete_ann(prefix_id);
                 }
             } else {
                 // Log announcements that arent handled by sorting
                 Logger::getInstance().log("Unsorted_Announcements") 
                     << "This announcement is being deleted and is not handled by sorting." 
-                    << " Prefix: " << prefix.to_cidr() 
+                    << " Prefix: " << PrefixTable::getInstance().cidr(prefix_id) 
                     << ", tstamp: " << timestamp 
                     << ", origin: " << as_path->at(path_l-1);
 
                 // Delete worse MRT announcement, proceed with seeding
-                as_on_path->delete_ann(prefix);
+                as_on_path->delete_ann(prefix_id);
             }
         }
         
@@ -340,44 +580,324 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::g
         }
         // No break in path so send the announcement
         if (!broken_path) {
-            AnnouncementType ann = AnnouncementType(*as_path->rbegin(),
-                                                    prefix.addr,
-                                                    prefix.netmask,
-                                                    priority,
-                                                    received_from_asn,
-                                                    timestamp,
-                                                    true);
+            AnnouncementType ann = seeded_ann;
+            ann.priority = priority;
+            ann.received_from_asn = received_from_asn;
             // Send the announcement to the current AS
             as_on_path->process_announcement(ann, this->random_tiebraking);
+            touch(as_on_path);
             if (this->graph->inverse_results != NULL) {
                 auto set = this->graph->inverse_results->find(
-                        std::pair<Prefix<>,uint32_t>(ann.prefix, ann.origin));
+                        std::pair<uint32_t, uint32_t>(ann.prefix_id, ann.origin));
                 // Remove the AS from the prefix's inverse results
                 if (set != this->graph->inverse_results->end()) {
-                    set->second->erase(as_on_path->asn);
+                    set->second->reset(as_on_path->non_stub_index);
                 }
             }
         } else {
             // Report the broken path
             //std::cerr << "Broken path for " << *(it - 1) << ", " << *it << std::endl;
             
-            static int g_broken_path = 0;
+            static std::atomic<int> g_broken_path(0);
 
             // Log the part of path where break takes place
-            Logger::getInstance().log("Broken_Paths") << "Broken Path #" << g_broken_path << ", between these two ASes: " << *(it - 1) << ", " << *it;
+            Logger::getInstance().log("Broken_Paths") << "Broken Path #" << g_broken_path++ << ", between these two ASes: " << *(it - 1) << ", " << *it;
+        }
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_up() {
+    if (!pull_propagation) {
+        BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_up();
+        return;
+    }
+    if (sparse_propagation) {
+        propagate_up_sparse();
+        return;
+    }
+    size_t levels = this->graph->ases_by_rank->size();
+    // Pull from customers
+    for (size_t level = 0; level < levels; level++) {
+        for_each_in_rank(*this->graph->ases_by_rank->at(level), [&](ASType *as) {
+            // Anything sent directly still comes first
+            as->process_announcements(this->random_tiebraking);
+            pull_announcements(as, this->graph->customer_csr->row(as->id), AS_REL_CUSTOMER);
+        }, this->graph->customer_csr);
+    }
+    // Pull from peers
+    if (threads > 1) {
+        // A peer's RIB must not grow while it is read, so queue everything first
+        for (size_t level = 0; level < levels; level++) {
+            for_each_in_rank(*this->graph->ases_by_rank->at(level), [&](ASType *as) {
+                pull_announcements(as, this->graph->peer_csr->row(as->id), AS_REL_PEER, true);
+            }, this->graph->peer_csr);
+        }
+        for (size_t level = 0; level < levels; level++) {
+            for_each_in_rank(*this->graph->ases_by_rank->at(level), [&](ASType *as) {
+                as->process_announcements(this->random_tiebraking);
+            });
+        }
+        return;
+    }
+    for (size_t level = 0; level < levels; level++) {
+        for (uint32_t id : *this->graph->ases_by_rank->at(level)) {
+            ASType *as = (*this->graph->ases_by_id)[id];
+            as->process_announcements(this->random_tiebraking);
+            pull_announcements(as, this->graph->peer_csr->row(id), AS_REL_PEER);
+        }
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_down() {
+    if (!pull_propagation) {
+        BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_down();
+        return;
+    }
+    if (sparse_propagation) {
+        propagate_down_sparse();
+        return;
+    }
+    size_t levels = this->graph->ases_by_rank->size();
+    for (size_t level = levels; level-- > 0;) {
+        for_each_in_rank(*this->graph->ases_by_rank->at(level), [&](ASType *as) {
+            as->process_announcements(this->random_tiebraking);
+            pull_announcements(as, this->graph->provider_csr->row(as->id), AS_REL_PROVIDER);
+        }, this->graph->provider_csr);
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_up_sparse() {
+    prepare_frontier();
+    size_t levels = this->graph->ases_by_rank->size();
+    std::vector<uint32_t> rank;
+    // Pull from customers, starting at the seeded ASes
+    for (uint32_t id : *touched)
+        enqueue(id);
+    for (size_t level = 0; level < levels; level++) {
+        take_frontier(level, rank);
+        for_each_in_rank(rank, [&](ASType *as) {
+            // Anything sent directly still comes first
+            as->process_announcements(this->random_tiebraking);
+            pull_announcements(as, this->graph->customer_csr->row(as->id), AS_REL_CUSTOMER);
+        }, this->graph->customer_csr);
+        advance_frontier(rank, this->graph->provider_csr);
+    }
+
+    // Pull from peers
+    for (uint32_t id : *touched) {
+        if (!(*this->graph->ases_by_id)[id]->all_anns->empty()) {
+            for (uint32_t peer_id : this->graph->peer_csr->row(id))
+                enqueue(peer_id);
+        }
+    }
+    std::vector<std::vector<uint32_t>> peer_ranks(levels);
+    for (size_t level = 0; level < levels; level++)
+        take_frontier(level, peer_ranks[level]);
+    if (threads > 1) {
+        // A peer's RIB must not grow while it is read, so queue everything first
+        for (size_t level = 0; level < levels; level++) {
+            for_each_in_rank(peer_ranks[level], [&](ASType *as) {
+                pull_announcements(as, this->graph->peer_csr->row(as->id), AS_REL_PEER, true);
+            }, this->graph->peer_csr);
+        }
+        for (size_t level = 0; level < levels; level++) {
+            for_each_in_rank(peer_ranks[level], [&](ASType *as) {
+                as->process_announcements(this->random_tiebraking);
+            });
+        }
+    } else {
+        for (size_t level = 0; level < levels; level++) {
+            for (uint32_t id : peer_ranks[level]) {
+                ASType *as = (*this->graph->ases_by_id)[id];
+                as->process_announcements(this->random_tiebraking);
+                pull_announcements(as, this->graph->peer_csr->row(id), AS_REL_PEER);
+            }
+        }
+    }
+    for (size_t level = 0; level < levels; level++)
+        advance_frontier(peer_ranks[level], NULL);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_down_sparse() {
+    prepare_frontier();
+    size_t levels = this->graph->ases_by_rank->size();
+    std::vector<uint32_t> rank;
+    // Customers of every AS holding announcements, those below them follow as they are reached
+    for (uint32_t id : *touched) {
+        if (!(*this->graph->ases_by_id)[id]->all_anns->empty()) {
+            for (uint32_t customer_id : this->graph->customer_csr->row(id))
+                enqueue(customer_id);
+        }
+    }
+    for (size_t level = levels; level-- > 0;) {
+        take_frontier(level, rank);
+        for_each_in_rank(rank, [&](ASType *as) {
+            as->process_announcements(this->random_tiebraking);
+            pull_announcements(as, this->graph->provider_csr->row(as->id), AS_REL_PROVIDER);
+        }, this->graph->provider_csr);
+        advance_frontier(rank, this->graph->customer_csr);
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::prepare_frontier() {
+    size_t num_ases = this->graph->ases_by_id->size();
+    if (queued == NULL || queued->size() != num_ases) {
+        delete queued;
+        delete touched_bits;
+        queued = new ASBitset(num_ases);
+        queued->clear();
+        touched_bits = new ASBitset(num_ases);
+        touched_bits->clear();
+        if (touched == NULL)
+            touched = new std::vector<uint32_t>;
+        touched->clear();
+    }
+    if (frontier == NULL)
+        frontier = new std::vector<std::vector<uint32_t>>;
+    // Removing relationships can drop the top ranks
+    frontier->resize(this->graph->ases_by_rank->size());
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::enqueue(uint32_t id) {
+    if (queued->test(id))
+        return;
+    queued->set(id);
+    (*frontier)[(*this->graph->ases_by_id)[id]->rank].push_back(id);
+}
 
-            g_broken_path++;
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::take_frontier(size_t level, 
+                                                                                               std::vector<uint32_t> &rank) {
+    rank.clear();
+    rank.swap((*frontier)[level]);
+    for (uint32_t id : rank)
+        queued->reset(id);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::advance_frontier(const std::vector<uint32_t> &rank, 
+                                                                                                  const CSRAdjacency *next) {
+    for (uint32_t id : rank) {
+        ASType *as = (*this->graph->ases_by_id)[id];
+        touch(as);
+        if (next != NULL && !as->all_anns->empty()) {
+            for (uint32_t neighbor_id : next->row(id))
+                enqueue(neighbor_id);
+        }
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::touch(ASType *as) {
+    if (!sparse_propagation)
+        return;
+    if (touched_bits == NULL || touched_bits->size() != this->graph->ases_by_id->size())
+        prepare_frontier();
+    if (touched_bits->test(as->id))
+        return;
+    touched_bits->set(as->id);
+    touched->push_back(as->id);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::clear_block() {
+    if (!sparse_propagation || touched == NULL) {
+        this->graph->clear_announcements();
+        return;
+    }
+    this->graph->clear_announcements(*touched);
+    for (uint32_t id : *touched)
+        touched_bits->reset(id);
+    touched->clear();
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+template <typename Function>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::for_each_in_rank(const std::vector<uint32_t> &rank, 
+                                                                                                  Function f,
+                                                                                                  const CSRAdjacency *sources) {
+    if (threads <= 1) {
+        for (uint32_t id : rank)
+            f((*this->graph->ases_by_id)[id]);
+        return;
+    }
+    if (pool == NULL || pool->size() != threads) {
+        delete pool;
+        pool = new ThreadPool(threads);
+    }
+    auto body = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            f((*this->graph->ases_by_id)[rank[i]]);
+    };
+    if (sources == NULL) {
+        pool->parallel_for(rank.size(), body);
+        return;
+    }
+    // An AS costs about as much as the announcements it will read
+    std::vector<uint64_t> cost(rank.size());
+    for (size_t i = 0; i < rank.size(); i++) {
+        cost[i] = 1;
+        for (uint32_t neighbor_id : sources->row(rank[i]))
+            cost[i] += (*this->graph->ases_by_id)[neighbor_id]->all_anns->size();
+    }
+    pool->parallel_for(rank.size(), cost, body);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::pull_announcements(ASType *as, 
+                                                                                                    CSRAdjacency::Row neighbors, 
+                                                                                                    uint32_t relationship,
+                                                                                                    bool defer) {
+    // Providers export everything to customers, everyone else only customer routes
+    bool customer_routes_only = relationship != AS_REL_PROVIDER;
+    for (uint32_t neighbor_id : neighbors) {
+        ASType *neighbor = (*this->graph->ases_by_id)[neighbor_id];
+        for (auto &entry : *neighbor->all_anns) {
+            const AnnouncementType &held = entry.second;
+            if (customer_routes_only && held.priority < 200) {
+                continue;
+            }
+            // Seeded announcements are never replaced
+            auto search = as->all_anns->find(entry.first);
+            if (search != as->all_anns->end() && search->second.from_monitor) {
+                continue;
+            }
+
+            // Set the priority of the announcement at the receiver
+            uint32_t path_len_weight = held.priority % 100;
+            if (path_len_weight == 0) {
+                // For MRT ann at origin: old_priority = 400
+                path_len_weight = 99;
+            } else {
+                // Sub 1 for the current hop
+                path_len_weight -= 1;
+            }
+
+            AnnouncementType ann = AnnouncementType(held);
+            ann.priority = relationship + path_len_weight;
+            ann.from_monitor = false;
+            ann.received_from_asn = neighbor->asn;
+            if (defer) {
+                as->incoming_announcements->push_back(ann);
+            } else {
+                as->process_announcement(ann, this->random_tiebraking);
+            }
         }
     }
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
-void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::send_all_announcements(uint32_t asn, 
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::send_all_announcements(ASType *source_as, 
                                                                                                         bool to_providers, 
                                                                                                         bool to_peers, 
                                                                                                         bool to_customers) {
-    // Get the AS that is sending it's announcements
-    auto *source_as = this->graph->ases->find(asn)->second; 
+    uint32_t asn = source_as->asn;
     // If we are sending to providers
     if (to_providers) {
         // Assemble the list of announcements to send to providers
@@ -419,9 +939,9 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::s
             anns_to_providers.push_back(temp);
         }
         // Send the vector of assembled announcements
-        for (uint32_t provider_asn : *source_as->providers) {
+        for (uint32_t provider_id : this->graph->provider_csr->row(source_as->id)) {
             // For each provider, give the vector of announcements
-            auto *recving_as = this->graph->ases->find(provider_asn)->second;
+            auto *recving_as = (*this->graph->ases_by_id)[provider_id];
             recving_as->receive_announcements(anns_to_providers);
         }
     }
@@ -467,9 +987,9 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::s
             anns_to_peers.push_back(temp);
         }
         // Send the vector of assembled announcements
-        for (uint32_t peer_asn : *source_as->peers) {
+        for (uint32_t peer_id : this->graph->peer_csr->row(source_as->id)) {
             // For each provider, give the vector of announcements
-            auto *recving_as = this->graph->ases->find(peer_asn)->second;
+            auto *recving_as = (*this->graph->ases_by_id)[peer_id];
             recving_as->receive_announcements(anns_to_peers);
         }
     }
@@ -512,9 +1032,9 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::s
             anns_to_customers.push_back(temp);
         }
         // Send the vector of assembled announcements
-        for (uint32_t customer_asn : *source_as->customers) {
+        for (uint32_t customer_id : this->graph->customer_csr->row(source_as->id)) {
             // For each customer, give the vector of announcements
-            auto *recving_as = this->graph->ases->find(customer_asn)->second;
+            auto *recving_as = (*this->graph->ases_by_id)[customer_id];
             recving_as->receive_announcements(anns_to_customers);
         }
     }
@@ -74,18 +74,15 @@ void EZExtrapolator::perform_propagation() {
             ezStatistics << round << "," << successful_attacks << "," << successful_connections << "," << disconnections << "," << graph->origin_to_attacker_victim->size() << "," << ((double) successful_attacks / (double) graph->origin_to_attacker_victim->size()) << std::endl;
 
             //Disconnect attacker from provider
-            //Reset memory for the graph so it can calculate ranks, components, etc... accordingly
+            //Ranks are maintained incrementally, so only per-round state needs resetting
             if(num_between == 0)
                 graph->disconnectAttackerEdges();
             graph->clear_announcements();
+            PathTable::getInstance().clear();
+            graph->victim_to_prefixes->clear();
 
             for(auto element : *graph->ases) {
-                element.second->rank = -1;
-                element.second->index = -1;
-                element.second->onStack = false;
-                element.second->lowlink = 0;
                 element.second->visited = false;
-                element.second->member_ases->clear();
 
                 if(element.second->inverse_results != NULL) {
                     for(auto i : *element.second->inverse_results)
@@ -94,21 +91,6 @@ void EZExtrapolator::perform_propagation() {
                     element.second->inverse_results->clear();
                 }
             }
-
-            for(auto element : *graph->ases_by_rank)
-                delete element;
-            graph->ases_by_rank->clear();
-
-            for(auto element : *graph->components)
-                delete element;
-            graph->components->clear();
-
-            graph->component_translation->clear();
-            graph->stubs_to_parents->clear();
-            graph->non_stubs->clear();
-
-            //Re calculate the components with these new relationships
-            graph->process(querier);
         } else {
             std::cout << "Round #" << round << ": No more attacks" << std::endl;
         }
@@ -163,6 +145,7 @@ void EZExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<
 
     EZAnnouncement attackAnnouncement = EZAnnouncement(path_origin_asn, prefix.addr, prefix.netmask, 299 - num_between, path_origin_asn, timestamp, true, true);
     attacker->process_announcement(attackAnnouncement, this->random_tiebraking);
+    touch(attacker);
 }
 
 uint32_t EZExtrapolator::getPathNeighborOfAttacker(EZAS* as, Prefix<> &prefix, uint32_t attacker_asn) {
@@ -210,7 +193,11 @@ void EZExtrapolator::calculate_successful_attacks() {
     graph->victim_to_prefixes->clear();
 }
 
-void EZExtrapolator::save_results(int iteration) {
-    // BaseExtrapolator::save_results(iteration);
+void EZExtrapolator::write_results(int iteration) {
+    // BaseExtrapolator::write_results(iteration);
     calculate_successful_attacks();
+}
+
+void EZExtrapolator::copy_results(int iteration) {
+    // BaseExtrapolator::copy_results(iteration);
 }
\ No newline at end of file
@@ -39,4 +39,35 @@ Extrapolator::Extrapolator(bool random_tiebraking,
 Extrapolator::Extrapolator() : Extrapolator(DEFAULT_RANDOM_TIEBRAKING, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
                                             ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, DEFAULT_ITERATION_SIZE) { }
 
-Extrapolator::~Extrapolator() { }
\ No newline at end of file
+Extrapolator::~Extrapolator() { }
+
+void Extrapolator::build_graph() {
+    // Snapshots are keyed by the database tables
+    if (topology_snapshot.empty() || !as_rel_file.empty()) {
+        BlockedExtrapolator::build_graph();
+        return;
+    }
+
+    std::string source_hash = querier->select_relationships_hash();
+    if (!source_hash.empty() && graph->load_snapshot(topology_snapshot, source_hash)) {
+        std::cout << "Loaded topology snapshot " << topology_snapshot << std::endl;
+        // The tables were cleared by init, so refill them from the loaded graph
+        graph->save_stubs_to_db(querier);
+        graph->save_non_stubs_to_db(querier);
+        graph->save_supernodes_to_db(querier);
+        return;
+    }
+
+    BlockedExtrapolator::build_graph();
+    if (!source_hash.empty() && graph->save_snapshot(topology_snapshot, source_hash))
+        std::cout << "Saved topology snapshot " << topology_snapshot << std::endl;
+}
+
+BlockedExtrapolator<SQLQuerier, ASGraph, Announcement, AS>* Extrapolator::create_worker() {
+    Extrapolator *worker = new Extrapolator(random_tiebraking, store_invert_results, store_depref_results,
+                                            querier->announcements_table, querier->results_table,
+                                            querier->inverse_results_table, querier->depref_table,
+                                            iteration_size);
+    worker->graph->share_topology(graph);
+    return worker;
+}
@@ -75,19 +75,18 @@ void ROVppExtrapolator::perform_propagation(bool propagate_twice=true) {
     for (const string table_name: {querier->simulation_table}) {
         // Get the prefix-origin pairs from the database
         pqxx::result prefix_origin_pairs = querier->select_all_pairs_from(table_name);
+        // Reused for every pair, fields are parsed from their bytes in place
+        std::vector<uint32_t> parsed_path;
         // Seed each of the prefix-origin pairs
         for (pqxx::result::const_iterator c = prefix_origin_pairs.begin(); c!=prefix_origin_pairs.end(); ++c) {
             // Extract Arguments needed for give_ann_to_as_path
-            std::vector<uint32_t>* parsed_path = parse_path(c["as_path"].as<string>());
-            Prefix<> the_prefix = Prefix<>(c["prefix_host"].as<string>(), c["prefix_netmask"].as<string>());
+            parse_path(c["as_path"].c_str(), parsed_path);
+            Prefix<> the_prefix = Prefix<>(c["prefix_host"].c_str(), c["prefix_netmask"].c_str());
             int64_t timestamp = 1;  // Bogus value just to satisfy function arguments (not actually being used)
             
             bool is_hijack = false; //table_name == querier->attack_table;
             // Seed the announcement
-            give_ann_to_as_path(parsed_path, the_prefix, timestamp, is_hijack);
-    
-            // Clean up
-            delete parsed_path;
+            give_ann_to_as_path(&parsed_path, the_prefix, timestamp, is_hijack);
         }
     }
     for (const string table_name: {querier->tracked_ases_table}) {
@@ -152,14 +151,15 @@ void ROVppExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path,
         // Increments path length, including prepending
         i++;
         // If ASN not in graph, continue
-        if (graph->ases->find(*it) == graph->ases->end()) {
+        // Supernode members and stubs are not in the graph, so no translation is needed
+        auto as_search = graph->ases->find(*it);
+        if (as_search == graph->ases->end()) {
             continue;
         }
-        // Translate ASN to it's supernode
-        uint32_t asn_on_path = graph->translate_asn(*it);
+        uint32_t asn_on_path = *it;
         cur_path.insert(cur_path.begin(), asn_on_path);
         // Find the current AS on the path
-        ROVppAS *as_on_path = graph->ases->find(asn_on_path)->second;
+        ROVppAS *as_on_path = as_search->second;
         // Check if already received this prefix
         if (as_on_path->already_received(ann_to_check_for)) {
             // update path vector
@@ -230,10 +230,10 @@ void ROVppExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path,
             as_on_path->process_announcement(ann, false);
             if (graph->inverse_results != NULL) {
                 auto set = graph->inverse_results->find(
-                        std::pair<Prefix<>,uint32_t>(ann.prefix, ann.origin));
+                        std::pair<uint32_t, uint32_t>(ann.prefix_id, ann.origin));
                 // Remove the AS from the prefix's inverse results
                 if (set != graph->inverse_results->end()) {
-                    set->second->erase(as_on_path->asn);
+                    set->second->reset(as_on_path->non_stub_index);
                 }
             }
         } else {
@@ -244,7 +244,7 @@ void ROVppExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path,
 
 void ROVppExtrapolator::process_withdrawal(uint32_t asn, ROVppAnnouncement ann, ROVppAS *neighbor) {
     // Get the neighbors announcement
-    auto neighbor_ann = neighbor->loc_rib->find(ann.prefix);
+    auto neighbor_ann = neighbor->loc_rib->find(ann.prefix_id);
     
     // If neighbors announcement came from previous AS (relevant withdrawal)
     if (neighbor_ann != neighbor->loc_rib->end() && 
@@ -288,35 +288,32 @@ void ROVppExtrapolator::propagate_up() {
     size_t levels = graph->ases_by_rank->size();
     // Propagate to providers
     for (size_t level = 0; level < levels; level++) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(false);
-            //ROVppAS *rovpp_as = dynamic_cast<ROVppAS*>(search->second);
-            //process_withdrawals(rovpp_as);
-            send_all_announcements(asn, true, false, false);
+        for (uint32_t id : *graph->ases_by_rank->at(level)) {
+            ROVppAS *as = (*graph->ases_by_id)[id];
+            as->process_announcements(false);
+            //process_withdrawals(as);
+            send_all_announcements(as, true, false, false);
         }
     }
     // Propagate to peers
     for (size_t level = 0; level < levels; level++) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(false);
-            //ROVppAS *rovpp_as = dynamic_cast<ROVppAS*>(search->second);
-            //process_withdrawals(rovpp_as);
-            send_all_announcements(asn, false, true, false);
+        for (uint32_t id : *graph->ases_by_rank->at(level)) {
+            ROVppAS *as = (*graph->ases_by_id)[id];
+            as->process_announcements(false);
+            //process_withdrawals(as);
+            send_all_announcements(as, false, true, false);
         }
     }
 }
 
 void ROVppExtrapolator::propagate_down() {
     size_t levels = graph->ases_by_rank->size();
-    for (size_t level = levels-1; level-- > 0;) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(false);
-            //ROVppAS *rovpp_as = dynamic_cast<ROVppAS*>(search->second);
-            //process_withdrawals(rovpp_as);
-            send_all_announcements(asn, false, false, true);
+    for (size_t level = levels; level-- > 0;) {
+        for (uint32_t id : *graph->ases_by_rank->at(level)) {
+            ROVppAS *as = (*graph->ases_by_id)[id];
+            as->process_announcements(false);
+            //process_withdrawals(as);
+            send_all_announcements(as, false, false, true);
         }
     }
 }
@@ -337,13 +334,13 @@ uint32_t ROVppExtrapolator::get_priority(ROVppAnnouncement const& ann, uint32_t
 bool ROVppExtrapolator::is_filtered(ROVppAS *rovpp_as, ROVppAnnouncement const& ann) {
     bool filter_ann = false;
     for (auto blackhole_ann : *rovpp_as->blackholes) {
-        if (blackhole_ann.prefix == ann.prefix &&
+        if (blackhole_ann.prefix_id == ann.prefix_id &&
             blackhole_ann.origin == ann.origin) {
             filter_ann = true;
         }
     }
     for (auto ann_pair : *rovpp_as->preventive_anns) {
-        if (ann_pair.first.prefix == ann.prefix &&
+        if (ann_pair.first.prefix_id == ann.prefix_id &&
             ann_pair.first.origin == ann.origin) {
             filter_ann = true;
         }
@@ -351,10 +348,11 @@ bool ROVppExtrapolator::is_filtered(ROVppAS *rovpp_as, ROVppAnnouncement const&
     return filter_ann;
 }
 
-void ROVppExtrapolator::send_all_announcements(uint32_t asn, 
+void ROVppExtrapolator::send_all_announcements(ROVppAS *source_as, 
                                                bool to_providers, 
                                                bool to_peers, 
                                                bool to_customers) {
+    uint32_t asn = source_as->asn;
     std::vector<ROVppAnnouncement> anns_to_providers;
     std::vector<ROVppAnnouncement> anns_to_peers;
     std::vector<ROVppAnnouncement> anns_to_customers;
@@ -369,12 +367,6 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
     if (to_providers)
         i = 2;
 
-    // Get the AS that is sending it's announcements
-    // auto *source_as = graph->ases->find(asn)->second; 
-    // ROVppAS *rovpp_as = dynamic_cast<ROVppAS*>(source_as);
-
-    ROVppAS *source_as = graph->ases->find(asn)->second;
-    
     // For each withdrawal
     for (auto it = source_as->withdrawals->begin(); it != source_as->withdrawals->end();) {
         // TODO This shouldn't ever happen
@@ -394,16 +386,16 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
                 path_len_weight -= 1;
             }
             // Full path generation
-            auto cur_path = it->as_path;
+            uint32_t cur_path = it->path_id;
             // Handles appending after origin
-            if (cur_path.size() == 0 || cur_path.back() != asn) {
-                cur_path.push_back(asn);
+            if (cur_path == PathTable::EMPTY_PATH || PathTable::getInstance().asn(cur_path) != asn) {
+                cur_path = PathTable::getInstance().extend(cur_path, asn);
             }
             // Copy announcement
             ROVppAnnouncement copy = *it;
             copy.received_from_asn = asn;
             copy.from_monitor = false;
-            copy.as_path = cur_path;
+            copy.path_id = cur_path;
 
             // Do not propagate any announcements from peers/providers
             // Set the priority of the announcement at destination 
@@ -450,17 +442,17 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
         }
 
         // Full path generation
-        auto cur_path = ann.second.as_path;
+        uint32_t cur_path = ann.second.path_id;
         // Handles appending after origin
-        if (cur_path.size() == 0 || cur_path.back() != asn) {
-            cur_path.push_back(asn);
+        if (cur_path == PathTable::EMPTY_PATH || PathTable::getInstance().asn(cur_path) != asn) {
+            cur_path = PathTable::getInstance().extend(cur_path, asn);
         }
 
         // Copy announcement
         ROVppAnnouncement copy = ann.second;
         copy.received_from_asn = asn;
         copy.from_monitor = false;
-        copy.as_path = cur_path;
+        copy.path_id = cur_path;
 
         // Do not propagate any announcements from peers/providers
         if (to_providers && ann.second.priority >= 200) {
@@ -498,15 +490,15 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
     }
     
     // Send the vectors of assembled announcements
-    for (uint32_t provider_asn : *source_as->providers) {
+    for (uint32_t provider_id : graph->provider_csr->row(source_as->id)) {
         // For each provider, give the vector of announcements
-        auto *recving_as = graph->ases->find(provider_asn)->second;
+        auto *recving_as = (*graph->ases_by_id)[provider_id];
         // NOTE SENT TO ASN IS NO LONGER SET
         recving_as->receive_announcements(anns_to_providers);
     }
-    for (uint32_t peer_asn : *source_as->peers) {
+    for (uint32_t peer_id : graph->peer_csr->row(source_as->id)) {
         // For each provider, give the vector of announcements
-        auto *recving_as = graph->ases->find(peer_asn)->second;
+        auto *recving_as = (*graph->ases_by_id)[peer_id];
         recving_as->receive_announcements(anns_to_peers);
     }
     if (source_as != NULL && source_as->policy_vector.size() > 0 &&
@@ -519,7 +511,7 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
         // to the customer anyway and include a withdraw ann to immediately remove it.
         std::vector<uint32_t> customer_asn_sent_prefix;
         for (ROVppAnnouncement curr_ann : *source_as->passed_rov) {
-            if (curr_ann.prefix.netmask == 0xFFFF0000) {
+            if (curr_ann.prefix().netmask == 0xFFFF0000) {
                 customer_asn_sent_prefix.push_back(curr_ann.received_from_asn);
             }
         }
@@ -528,7 +520,7 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
         std::vector<ROVppAnnouncement> preventive_ann_withdraws;
         for (auto ann_pair : *source_as->preventive_anns) {
             for (ROVppAnnouncement to_cust_ann : anns_to_customers) {
-                if (ann_pair.first.prefix == to_cust_ann.prefix &&
+                if (ann_pair.first.prefix_id == to_cust_ann.prefix_id &&
                     ann_pair.first.origin == to_cust_ann.origin) {
                     // Create Withdraw Ann
                     ROVppAnnouncement copy = to_cust_ann;
@@ -542,9 +534,9 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
         // Send Announcements to Customers, but inject preventive announcemnt 
         // withdraws to the anns_to_customers if the AS shared the prefix
         // with this AS (source_as || rovpp_as)
-        for (uint32_t customer_asn : *source_as->customers) {
+        for (uint32_t customer_id : graph->customer_csr->row(source_as->id)) {
             // For each customer, give the vector of announcements
-            auto *recving_as = graph->ases->find(customer_asn)->second;
+            auto *recving_as = (*graph->ases_by_id)[customer_id];
             // Copy vector of anns to send to customer
             std::vector<ROVppAnnouncement> copy_anns_to_customers = anns_to_customers;
             // Check if the ASN of this AS in included in the list of customer_asn_sent_prefix
@@ -557,9 +549,9 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
             recving_as->receive_announcements(copy_anns_to_customers);
         }
     } else {
-        for (uint32_t customer_asn : *source_as->customers) {
+        for (uint32_t customer_id : graph->customer_csr->row(source_as->id)) {
             // For each customer, give the vector of announcements
-            auto *recving_as = graph->ases->find(customer_asn)->second;
+            auto *recving_as = (*graph->ases_by_id)[customer_id];
             recving_as->receive_announcements(anns_to_customers);
         }
     }
@@ -575,9 +567,12 @@ void ROVppExtrapolator::send_all_announcements(uint32_t asn,
     }
 }
 
-bool ROVppExtrapolator::loop_check(Prefix<> p, const ROVppAS& cur_as, uint32_t a, int d) {
+bool ROVppExtrapolator::loop_check(uint32_t prefix_id, const ROVppAS& cur_as, uint32_t a, int d) {
     if (d > 100) { std::cerr << "Maximum depth exceeded during traceback.\n"; return true; }
-    auto ann_pair = cur_as.loc_rib->find(p);
+    auto ann_pair = cur_as.loc_rib->find(prefix_id);
+    if (ann_pair == cur_as.loc_rib->end()) { 
+        return false; 
+    }
     const Announcement &ann = ann_pair->second;
     // i wonder if a cabinet holding a subwoofer counts as a bass case
     // Ba dum tss, nice
@@ -587,13 +582,10 @@ bool ROVppExtrapolator::loop_check(Prefix<> p, const ROVppAS& cur_as, uint32_t a
         ann.received_from_asn == 64514) {
         return false;
     }
-    if (ann_pair == cur_as.loc_rib->end()) { 
-        return false; 
-    }
     auto next_as_pair = graph->ases->find(ann.received_from_asn);
     if (next_as_pair == graph->ases->end()) { std::cerr << "Traced back announcement to nonexistent AS.\n"; return true; }
     const ROVppAS& next_as = *next_as_pair->second;
-    return loop_check(p, next_as, a, d+1);
+    return loop_check(prefix_id, next_as, a, d+1);
 }
 
 void ROVppExtrapolator::save_results(int iteration) {
@@ -25,9 +25,22 @@
 #include <iostream>
 #include <set>
 #include <vector>
-#include <stack>
+#include <deque>
+#include <queue>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
 #include <algorithm>
+#include <stdexcept>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
 #include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "Graphs/ASGraph.h"
 #include "ASes/AS.h"
@@ -37,14 +50,7 @@ BaseGraph<ASType>::~BaseGraph() {
     for (auto const& as : *ases)
         delete as.second;
     delete ases;
-    
-    for (auto const& as : *ases_by_rank)
-        delete as;
-    delete ases_by_rank;
-
-    for (auto const& c : *components)
-        delete c;
-    delete components;
+    delete ases_by_id;
 
     if(inverse_results != NULL) {
         for (auto const& i : *inverse_results)
@@ -52,15 +58,48 @@ BaseGraph<ASType>::~BaseGraph() {
         delete inverse_results;
     }
 
-    delete component_translation;
-    delete stubs_to_parents;
-    delete non_stubs;
+    if (owns_topology) {
+        for (auto const& as : *ases_by_rank)
+            delete as;
+        delete ases_by_rank;
+
+        delete components;
+        delete component_translation;
+        delete stubs_to_parents;
+        delete non_stubs;
+        delete provider_csr;
+        delete peer_csr;
+        delete customer_csr;
+    }
+    // After the ASes, whose announcements may live in it
+    delete announcement_arena;
+}
+
+template <class ASType>
+ASType* BaseGraph<ASType>::create_as(uint32_t asn) {
+    ASType *as = createNew(asn);
+    as->use_arena(announcement_arena);
+    return as;
 }
 
 template <class ASType>
 void BaseGraph<ASType>::clear_announcements() {
     for (auto const& as : *ases)
         as.second->clear_announcements();
+    announcement_arena->reset();
+
+    if(inverse_results != NULL) {
+        for (auto const& i : *inverse_results)
+            delete i.second;
+        inverse_results->clear();
+    }
+}
+
+template <class ASType>
+void BaseGraph<ASType>::clear_announcements(const std::vector<uint32_t> &ids) {
+    for (uint32_t id : ids)
+        (*ases_by_id)[id]->clear_announcements();
+    announcement_arena->reset();
 
     if(inverse_results != NULL) {
         for (auto const& i : *inverse_results)
@@ -70,19 +109,132 @@ void BaseGraph<ASType>::clear_announcements() {
 }
 
 template <class ASType>
-void BaseGraph<ASType>::add_relationship(uint32_t asn, 
+void BaseGraph<ASType>::share_topology(BaseGraph<ASType> *other) {
+    if (owns_topology) {
+        for (auto const& as : *ases_by_rank)
+            delete as;
+        delete ases_by_rank;
+        delete components;
+        delete component_translation;
+        delete stubs_to_parents;
+        delete non_stubs;
+        delete provider_csr;
+        delete peer_csr;
+        delete customer_csr;
+    }
+    ases_by_rank = other->ases_by_rank;
+    components = other->components;
+    component_translation = other->component_translation;
+    stubs_to_parents = other->stubs_to_parents;
+    non_stubs = other->non_stubs;
+    provider_csr = other->provider_csr;
+    peer_csr = other->peer_csr;
+    customer_csr = other->customer_csr;
+    owns_topology = false;
+
+    // A counterpart for every AS, at the same id
+    ases->reserve(other->ases->size());
+    ases_by_id->assign(other->ases_by_id->size(), NULL);
+    for (auto const& as : *other->ases) {
+        ASType *counterpart = create_as(as.first);
+        counterpart->share_topology(*as.second);
+        ases->insert(std::pair<uint32_t, ASType*>(as.first, counterpart));
+        if (counterpart->id < ases_by_id->size())
+            (*ases_by_id)[counterpart->id] = counterpart;
+    }
+}
+
+template <class ASType>
+void BaseGraph<ASType>::add_relationship(uint32_t asn,
                                             uint32_t neighbor_asn, 
                                             int relation) {
     auto search = ases->find(asn);
     if (search == ases->end()) {
         // if AS not yet in graph, create it
         // ases->insert(std::pair<uint32_t, ASType*>(asn, new ASType(asn, inverse_results)));
-        ases->insert(std::pair<uint32_t, ASType*>(asn, createNew(asn)));
+        ases->insert(std::pair<uint32_t, ASType*>(asn, create_as(asn)));
         search = ases->find(asn);
     }
     search->second->add_neighbor(neighbor_asn, relation);
 }
 
+template <class ASType>
+void BaseGraph<ASType>::remove_relationships(const std::vector<std::pair<uint32_t, uint32_t>> &edges) {
+    // (row, neighbor) ids to drop from each adjacency array
+    std::vector<std::pair<uint32_t, uint32_t>> removed_providers, removed_peers, removed_customers;
+    // ASes that lost a customer, with the rank they had
+    std::priority_queue<std::pair<int, uint32_t>, 
+                        std::vector<std::pair<int, uint32_t>>, 
+                        std::greater<std::pair<int, uint32_t>>> to_rank;
+
+    for (auto &edge : edges) {
+        auto first_search = ases->find(edge.first);
+        auto second_search = ases->find(edge.second);
+        if (first_search == ases->end() || second_search == ases->end())
+            continue;
+        ASType *first = first_search->second;
+        ASType *second = second_search->second;
+        // Orient the edge so customer buys transit from provider
+        ASType *customer = NULL, *provider = NULL;
+        if (first->providers->erase(second->asn)) {
+            customer = first;
+            provider = second;
+        } else if (first->customers->erase(second->asn)) {
+            customer = second;
+            provider = first;
+        }
+
+        if (customer != NULL) {
+            provider->customers->erase(customer->asn);
+            customer->providers->erase(provider->asn);
+            removed_providers.push_back(std::make_pair(customer->id, provider->id));
+            removed_customers.push_back(std::make_pair(provider->id, customer->id));
+            to_rank.push(std::make_pair(provider->rank, provider->id));
+        } else if (first->peers->erase(second->asn)) {
+            second->peers->erase(first->asn);
+            removed_peers.push_back(std::make_pair(first->id, second->id));
+            removed_peers.push_back(std::make_pair(second->id, first->id));
+        }
+    }
+    provider_csr->remove_neighbors(removed_providers);
+    peer_csr->remove_neighbors(removed_peers);
+    customer_csr->remove_neighbors(removed_customers);
+
+    // Ranks can only fall. Settling ASes from the lowest old rank up means all
+    // customers of an AS are final before it is re-ranked.
+    auto by_asn = [this](uint32_t id, uint32_t asn) { return (*ases_by_id)[id]->asn < asn; };
+    while (!to_rank.empty()) {
+        int old_rank = to_rank.top().first;
+        ASType *as = (*ases_by_id)[to_rank.top().second];
+        to_rank.pop();
+        // Skip ASes already re-ranked through another customer
+        if (as->rank != old_rank)
+            continue;
+        int new_rank = 0;
+        for (uint32_t customer_id : customer_csr->row(as->id))
+            new_rank = std::max(new_rank, (*ases_by_id)[customer_id]->rank + 1);
+        if (new_rank == old_rank)
+            continue;
+
+        // Move the AS to its new rank, keeping ASN order within the rank
+        std::vector<uint32_t> *from = (*ases_by_rank)[old_rank];
+        std::vector<uint32_t> *to = (*ases_by_rank)[new_rank];
+        from->erase(std::lower_bound(from->begin(), from->end(), as->asn, by_asn));
+        to->insert(std::lower_bound(to->begin(), to->end(), as->asn, by_asn), as->id);
+        as->rank = new_rank;
+
+        for (uint32_t provider_id : provider_csr->row(as->id))
+            to_rank.push(std::make_pair((*ases_by_id)[provider_id]->rank, provider_id));
+    }
+
+    // Only the top ranks can empty out
+    while (!ases_by_rank->empty() && ases_by_rank->back()->empty()) {
+        delete ases_by_rank->back();
+        ases_by_rank->pop_back();
+    }
+    sort_rows_by_rank();
+}
+
 template <class ASType>
 uint32_t BaseGraph<ASType>::translate_asn(uint32_t asn) {
     auto search = component_translation->find(asn);
@@ -94,35 +246,143 @@ uint32_t BaseGraph<ASType>::translate_asn(uint32_t asn) {
 template <class ASType>
 void BaseGraph<ASType>::process(SQLQuerier *querier) {
     remove_stubs(querier);
-    tarjan();
+    find_components();
     combine_components();
     save_supernodes_to_db(querier);
     decide_ranks();
+    index_non_stubs();
+}
+
+template <class ASType>
+void BaseGraph<ASType>::index_non_stubs() {
+    for (uint32_t i = 0; i < non_stubs->size(); i++) {
+        auto search = ases->find(non_stubs->at(i));
+        if (search != ases->end())
+            search->second->non_stub_index = i;
+    }
 }
 
 template <class ASType>
 void BaseGraph<ASType>::create_graph_from_db(SQLQuerier *querier) {
+    add_relationships_from_db(querier);
+    process(querier);
+}
+
+template <class ASType>
+void BaseGraph<ASType>::add_relationships_from_db(SQLQuerier *querier) {
+    // Flat buffer of (first ASN, second ASN) pairs
+    std::vector<uint32_t> edges;
+
     // Assemble Peers
-    pqxx::result R = querier->select_from_table(PEERS_TABLE);
-    for (pqxx::result::const_iterator c = R.begin(); c!=R.end(); ++c){
-        add_relationship(c["peer_as_1"].as<uint32_t>(),
-                         c["peer_as_2"].as<uint32_t>(),AS_REL_PEER);
-        add_relationship(c["peer_as_2"].as<uint32_t>(),
-                         c["peer_as_1"].as<uint32_t>(),AS_REL_PEER);
+    if (!querier->copy_columns_from_db("SELECT peer_as_1, peer_as_2 FROM " PEERS_TABLE, 2, edges))
+        throw std::runtime_error("Failed to read relationships from " PEERS_TABLE);
+    for (size_t i = 0; i + 1 < edges.size(); i += 2) {
+        add_relationship(edges[i], edges[i + 1], AS_REL_PEER);
+        add_relationship(edges[i + 1], edges[i], AS_REL_PEER);
     }
 
     // Assemble Customer-Providers
-    R = querier->select_from_table(CUSTOMER_PROVIDER_TABLE);
-    for (pqxx::result::const_iterator c = R.begin(); c!=R.end(); ++c){
-        add_relationship(c["customer_as"].as<uint32_t>(),
-                         c["provider_as"].as<uint32_t>(),AS_REL_PROVIDER);
-        add_relationship(c["provider_as"].as<uint32_t>(),
-                         c["customer_as"].as<uint32_t>(),AS_REL_CUSTOMER);
+    edges.clear();
+    if (!querier->copy_columns_from_db("SELECT customer_as, provider_as FROM " CUSTOMER_PROVIDER_TABLE, 2, edges))
+        throw std::runtime_error("Failed to read relationships from " CUSTOMER_PROVIDER_TABLE);
+    for (size_t i = 0; i + 1 < edges.size(); i += 2) {
+        add_relationship(edges[i], edges[i + 1], AS_REL_PROVIDER);
+        add_relationship(edges[i + 1], edges[i], AS_REL_CUSTOMER);
     }
+}
 
+/** Parse an unsigned decimal field of an as-rel line.
+ *
+ *  @param cur Start of the field, advanced past it
+ *  @param end End of the line
+ *  @param value Parsed value
+ *  @return true if the field held at least one digit and fit in 32 bits
+ */
+static bool parse_as_rel_field(const char *&cur, const char *end, uint32_t &value) {
+    uint64_t acc = 0;
+    const char *start = cur;
+    while (cur < end && *cur >= '0' && *cur <= '9' && acc <= UINT32_MAX) {
+        acc = acc * 10 + (*cur - '0');
+        cur++;
+    }
+    value = acc;
+    return cur != start && acc <= UINT32_MAX;
+}
+
+template <class ASType>
+void BaseGraph<ASType>::create_graph_from_file(std::string path, SQLQuerier *querier) {
+    if (!add_relationships_from_file(path))
+        throw std::runtime_error("Failed to read AS relationships from " + path);
     process(querier);
 }
 
+template <class ASType>
+bool BaseGraph<ASType>::add_relationships_from_file(std::string path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t file_size = st.st_size;
+    if (file_size == 0) {
+        close(fd);
+        return true;
+    }
+    void *mapped = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return false;
+    madvise(mapped, file_size, MADV_SEQUENTIAL);
+
+    // Lines are <provider-as>|<customer-as>|-1 or <peer-as>|<peer-as>|0,
+    // serial-2 files add a |<source> field that is ignored
+    const char *cur = static_cast<const char*>(mapped);
+    const char *end = cur + file_size;
+    uint32_t malformed = 0;
+    while (cur < end) {
+        const char *eol = static_cast<const char*>(memchr(cur, '\n', end - cur));
+        if (eol == NULL)
+            eol = end;
+        const char *line_end = (eol > cur && eol[-1] == '\r') ? eol - 1 : eol;
+
+        // Skip comments and blank lines
+        if (cur < line_end && *cur != '#') {
+            uint32_t first_asn, second_asn, rel;
+            bool provider = false;
+            bool valid = parse_as_rel_field(cur, line_end, first_asn) && 
+                         cur < line_end && *cur++ == '|' &&
+                         parse_as_rel_field(cur, line_end, second_asn) && 
+                         cur < line_end && *cur++ == '|';
+            if (valid && cur < line_end && *cur == '-') {
+                provider = true;
+                cur++;
+            }
+            valid = valid && parse_as_rel_field(cur, line_end, rel) && 
+                    (cur == line_end || *cur == '|') &&
+                    ((provider && rel == 1) || (!provider && rel == 0));
+
+            if (!valid) {
+                malformed++;
+            } else if (provider) {
+                add_relationship(second_asn, first_asn, AS_REL_PROVIDER);
+                add_relationship(first_asn, second_asn, AS_REL_CUSTOMER);
+            } else {
+                add_relationship(first_asn, second_asn, AS_REL_PEER);
+                add_relationship(second_asn, first_asn, AS_REL_PEER);
+            }
+        }
+        cur = eol + 1;
+    }
+    munmap(mapped, file_size);
+
+    if (malformed > 0)
+        std::cerr << "Skipped " << malformed << " malformed lines in " << path << std::endl;
+    return true;
+}
+
 template <class ASType>
 void BaseGraph<ASType>::remove_stubs(SQLQuerier *querier) {
     std::vector<ASType*> to_remove;
@@ -163,6 +423,10 @@ void BaseGraph<ASType>::remove_stubs(SQLQuerier *querier) {
 
 template <class ASType>
 void BaseGraph<ASType>::save_stubs_to_db(SQLQuerier *querier) {
+    // Graphs built without a database have nowhere to save to
+    if (querier == NULL)
+        return;
+
     DIR* dir = opendir("/dev/shm/bgp");
     if(!dir)
         mkdir("/dev/shm/bgp",0777);
@@ -184,6 +448,9 @@ void BaseGraph<ASType>::save_stubs_to_db(SQLQuerier *querier) {
 
 template <class ASType>
 void BaseGraph<ASType>::save_non_stubs_to_db(SQLQuerier *querier) {
+    if (querier == NULL)
+        return;
+
     DIR* dir = opendir("/dev/shm/bgp");
     if(!dir)
         mkdir("/dev/shm/bgp",0777);
@@ -205,6 +472,9 @@ void BaseGraph<ASType>::save_non_stubs_to_db(SQLQuerier *querier) {
 
 template <class ASType>
 void BaseGraph<ASType>::save_supernodes_to_db(SQLQuerier *querier) {
+    if (querier == NULL)
+        return;
+
     DIR* dir = opendir("/dev/shm/bgp");
     if(!dir)
         mkdir("/dev/shm/bgp",0777);
@@ -216,21 +486,9 @@ void BaseGraph<ASType>::save_supernodes_to_db(SQLQuerier *querier) {
     std::string file_name = "/dev/shm/bgp/supernodes.csv";
     outfile.open(file_name); 
     
-    // Iterate over each strongly connected components
-    for (auto &cur_node : *components) {
-        // For each supernode
-        if (cur_node->size() > 1) {
-            // Find the lowest ASN in supernode
-            uint32_t low = UINT_MAX;
-            for (auto &cur_asn : *cur_node) {
-                if (cur_asn < low) 
-                    low = cur_asn;
-            }
-            // Assemble rows as pairs; ASN in supernode, lowest ASN in that supernode
-            for (auto &cur_asn : *cur_node)
-                outfile << cur_asn << "," << low << "\n";
-        }
-    }
+    // Assemble rows as pairs; ASN in supernode, lowest ASN in that supernode
+    for (auto &translation : *component_translation)
+        outfile << translation.first << "," << translation.second << "\n";
 
     outfile.close();
     querier->copy_supernodes_to_db(file_name);
@@ -239,192 +497,691 @@ void BaseGraph<ASType>::save_supernodes_to_db(SQLQuerier *querier) {
 
 template <class ASType>
 void BaseGraph<ASType>::decide_ranks() {
+    build_adjacency();
+
+    for (auto const& r : *ases_by_rank)
+        delete r;
     ases_by_rank->clear();
 
-    // Initial set of customer ASes at the bottom of the DAG
-    ases_by_rank->push_back(new std::set<uint32_t>());
-    // For ASes with no customers
-    for (auto &as : *ases) {
-        // If AS is a leaf node
-        if (as.second->customers->empty()) {
-            (*ases_by_rank)[0]->insert(as.first);
-            as.second->rank = 0;
+    uint32_t num_ases = ases_by_id->size();
+    // Number of customers each AS is still waiting on
+    std::vector<uint32_t> waiting(num_ases, 0);
+    for (uint32_t id = 0; id < num_ases; id++)
+        for (uint32_t provider_id : provider_csr->row(id))
+            waiting[provider_id]++;
+
+    // Start from ASes with no customers, at the bottom of the DAG
+    std::vector<uint32_t> ready;
+    ready.reserve(num_ases);
+    for (uint32_t id = 0; id < num_ases; id++) {
+        (*ases_by_id)[id]->rank = 0;
+        if (waiting[id] == 0)
+            ready.push_back(id);
+    }
+
+    // An AS is ready once all its customers have final ranks
+    int max_rank = -1;
+    for (size_t next = 0; next < ready.size(); next++) {
+        ASType *as = (*ases_by_id)[ready[next]];
+        max_rank = std::max(max_rank, as->rank);
+        for (uint32_t provider_id : provider_csr->row(as->id)) {
+            ASType *prov_AS = (*ases_by_id)[provider_id];
+            prov_AS->rank = std::max(prov_AS->rank, as->rank + 1);
+            if (--waiting[provider_id] == 0)
+                ready.push_back(provider_id);
         }
     }
-    
-    int i = 0;
-    // While there are elements to process current rank
-    while (!(*ases_by_rank)[i]->empty()) {
-        ases_by_rank->push_back(new std::set<uint32_t>());
-        for (uint32_t asn : *(*ases_by_rank)[i]) {
-            //For all providers of this AS
-            for (const uint32_t &provider_asn : *ases->find(asn)->second->providers) {
-                ASType* prov_AS = ases->find(translate_asn(provider_asn))->second;
-                int oldrank = prov_AS->rank;
-                // Move provider up to next rank
-                if (oldrank < i + 1) {
-                    prov_AS->rank = i + 1;
-                    (*ases_by_rank)[i+1]->insert(provider_asn);
-                    if (oldrank != -1) {
-                        (*ases_by_rank)[oldrank]->erase(provider_asn);
-                    }
-                }
-            }
+
+    if (ready.size() != num_ases) {
+        std::cerr << "Provider cycle left in graph, " << num_ases - ready.size() 
+                  << " ASes were not ranked." << std::endl;
+    }
+
+    // Bucket ranked ASes, keeping id order within each rank
+    std::vector<uint32_t> widths(max_rank + 1, 0);
+    for (uint32_t id : ready)
+        widths[(*ases_by_id)[id]->rank]++;
+    for (uint32_t width : widths) {
+        ases_by_rank->push_back(new std::vector<uint32_t>());
+        ases_by_rank->back()->reserve(width);
+    }
+    // Ids are dense, so one pass in id order fills every rank already sorted
+    for (uint32_t id = 0; id < num_ases; id++) {
+        // ASes still waiting on a customer sit on a cycle and were not ranked
+        if (waiting[id] == 0)
+            (*ases_by_rank)[(*ases_by_id)[id]->rank]->push_back(id);
+    }
+
+    if (rank_major_ids)
+        renumber_by_rank();
+    sort_rows_by_rank();
+}
+
+template <class ASType>
+void BaseGraph<ASType>::sort_rows_by_rank() {
+    // Position of each AS in propagate_up, and in propagate_down which walks the ranks top down
+    std::vector<uint64_t> up_order(ases_by_id->size()), down_order(ases_by_id->size());
+    for (uint32_t id = 0; id < up_order.size(); id++) {
+        ASType *as = (*ases_by_id)[id];
+        up_order[id] = (static_cast<uint64_t>(as->rank) << 32) | as->asn;
+        down_order[id] = (static_cast<uint64_t>(INT32_MAX - as->rank) << 32) | as->asn;
+    }
+    // Customers and peers are read going up, providers coming down
+    customer_csr->sort_rows([&up_order](uint32_t a, uint32_t b) { return up_order[a] < up_order[b]; });
+    peer_csr->sort_rows([&up_order](uint32_t a, uint32_t b) { return up_order[a] < up_order[b]; });
+    provider_csr->sort_rows([&down_order](uint32_t a, uint32_t b) { return down_order[a] < down_order[b]; });
+}
+
+template <class ASType>
+void BaseGraph<ASType>::renumber_by_rank() {
+    uint32_t num_ases = ases_by_id->size();
+    // Hand out new ids rank by rank, ASes left unranked by a cycle go last
+    std::vector<uint32_t> new_id(num_ases, UINT32_MAX);
+    std::vector<uint32_t> old_id;
+    old_id.reserve(num_ases);
+    for (auto const& r : *ases_by_rank) {
+        for (uint32_t &id : *r) {
+            new_id[id] = old_id.size();
+            old_id.push_back(id);
+            id = new_id[id];
         }
-        i++;
     }
-    return;
+    for (uint32_t id = 0; id < num_ases; id++) {
+        if (new_id[id] == UINT32_MAX) {
+            new_id[id] = old_id.size();
+            old_id.push_back(id);
+        }
+    }
+
+    std::vector<ASType*> renumbered_ases(num_ases);
+    for (uint32_t id = 0; id < num_ases; id++) {
+        ASType *as = (*ases_by_id)[old_id[id]];
+        as->id = id;
+        renumbered_ases[id] = as;
+    }
+    ases_by_id->swap(renumbered_ases);
+
+    // Move every row to its new position and translate the neighbor ids
+    std::vector<uint32_t> row;
+    for (CSRAdjacency *csr : {provider_csr, peer_csr, customer_csr}) {
+        CSRAdjacency renumbered;
+        renumbered.reset(num_ases, csr->neighbors.size());
+        for (uint32_t id = 0; id < num_ases; id++) {
+            row.clear();
+            for (uint32_t neighbor_id : csr->row(old_id[id]))
+                row.push_back(new_id[neighbor_id]);
+            renumbered.append_row(row);
+        }
+        std::swap(*csr, renumbered);
+    }
 }
 
 template <class ASType>
-void BaseGraph<ASType>::tarjan() {
-    int index = 0;
-    std::stack<ASType*> s;
+std::vector<uint32_t> BaseGraph<ASType>::rank_widths() const {
+    std::vector<uint32_t> widths;
+    widths.reserve(ases_by_rank->size());
+    for (auto const& r : *ases_by_rank)
+        widths.push_back(r->size());
+    return widths;
+}
 
+template <class ASType>
+void BaseGraph<ASType>::build_adjacency() {
+    // Assign dense ids in ASN order so that runs are reproducible
+    ases_by_id->clear();
+    ases_by_id->reserve(ases->size());
     for (auto &as : *ases)
-        if (as.second->index == -1)
-            tarjan_helper(as.second, index, s);
-    return;
+        ases_by_id->push_back(as.second);
+    std::sort(ases_by_id->begin(), ases_by_id->end(), 
+              [](const ASType *a, const ASType *b) { return a->asn < b->asn; });
+
+    size_t num_providers = 0, num_peers = 0, num_customers = 0;
+    for (uint32_t id = 0; id < ases_by_id->size(); id++) {
+        ASType *as = (*ases_by_id)[id];
+        as->id = id;
+        // Count edges so each array is allocated once
+        num_providers += as->providers->size();
+        num_peers += as->peers->size();
+        num_customers += as->customers->size();
+    }
+    provider_csr->reset(ases->size(), num_providers);
+    peer_csr->reset(ases->size(), num_peers);
+    customer_csr->reset(ases->size(), num_customers);
+
+    // Translate each relationship set to ids, dropping ASNs not in the graph
+    std::vector<uint32_t> row;
+    auto append = [this, &row](CSRAdjacency *csr, std::set<uint32_t> *neighbor_asns) {
+        row.clear();
+        for (uint32_t neighbor_asn : *neighbor_asns) {
+            auto search = ases->find(neighbor_asn);
+            if (search != ases->end())
+                row.push_back(search->second->id);
+        }
+        csr->append_row(row);
+    };
+    for (ASType *as : *ases_by_id) {
+        append(provider_csr, as->providers);
+        append(peer_csr, as->peers);
+        append(customer_csr, as->customers);
+    }
 }
 
 template <class ASType>
-void BaseGraph<ASType>::tarjan_helper(ASType *as, int &index, std::stack<ASType*> &s) {
-    as->index = index;
-    as->lowlink = index;
-    index++;
-    s.push(as);
-    as->onStack = true;
-    
-    for (auto &neighbor : *(as->providers)) {
-        ASType *n = ases->find(neighbor)->second;
-        if (n->index == -1) {
-            tarjan_helper(n, index, s);
-            as->lowlink = std::min(as->lowlink, n->lowlink);
-        } else if (n->onStack) {
-            as->lowlink = std::min(as->lowlink, n->index);
+bool BaseGraph<ASType>::save_snapshot(std::string path, std::string source_hash) {
+    uint64_t num_ases = ases_by_id->size();
+    if (num_ases != ases->size() || provider_csr->num_rows() != num_ases ||
+        source_hash.size() >= TOPOLOGY_SNAPSHOT_HASH_SIZE) {
+        std::cerr << "Graph is not ready for a topology snapshot." << std::endl;
+        return false;
+    }
+
+    TopologySnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TOPOLOGY_SNAPSHOT_MAGIC, sizeof(TOPOLOGY_SNAPSHOT_MAGIC));
+    header.version = TOPOLOGY_SNAPSHOT_VERSION;
+    header.header_size = sizeof(header);
+    memcpy(header.source_hash, source_hash.data(), source_hash.size());
+    header.num_ases = num_ases;
+    header.num_provider_edges = provider_csr->neighbors.size();
+    header.num_peer_edges = peer_csr->neighbors.size();
+    header.num_customer_edges = customer_csr->neighbors.size();
+    header.num_stubs = stubs_to_parents->size();
+    header.num_translations = component_translation->size();
+    header.num_non_stubs = non_stubs->size();
+
+    std::string tmp_path = path + ".tmp";
+    std::ofstream outfile(tmp_path, std::ios::binary | std::ios::trunc);
+    auto write_array = [&outfile](const std::vector<uint32_t> &values) {
+        outfile.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(uint32_t));
+    };
+    outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<uint32_t> values;
+    values.reserve(num_ases);
+    for (ASType *as : *ases_by_id)
+        values.push_back(as->asn);
+    write_array(values);
+    values.clear();
+    for (ASType *as : *ases_by_id)
+        values.push_back(as->rank);
+    write_array(values);
+    for (CSRAdjacency *csr : {provider_csr, peer_csr, customer_csr}) {
+        write_array(csr->offsets);
+        write_array(csr->neighbors);
+    }
+    for (auto const *pairs : {stubs_to_parents, component_translation}) {
+        values.clear();
+        for (auto const &pair : *pairs) {
+            values.push_back(pair.first);
+            values.push_back(pair.second);
         }
+        write_array(values);
     }
+    write_array(*non_stubs);
 
-    if (as->lowlink == as->index) {
-        std::vector<uint32_t> *component = new std::vector<uint32_t>;
-        ASType *as_from_stack;
-        do {
-            as_from_stack = s.top();
-            s.pop();
-            as_from_stack->onStack = false;
-            component->push_back(as_from_stack->asn);
-        } while (as_from_stack != as);
-        /** TODO Add logging here
-        if (component->size() > 1)
-            std::cout << "Supernode found of size " << component->size() << std::endl;
-        */
-        components->push_back(component);
+    outfile.close();
+    if (!outfile || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to write topology snapshot " << path << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
     }
+    return true;
 }
 
 template <class ASType>
-void BaseGraph<ASType>::combine_components() {
-    
-    // For each strongly connected component
-    for (auto const& component : *components) {
-        // Ignore single AS nodes
-        if (component->size() <= 1)
+bool BaseGraph<ASType>::load_snapshot(std::string path, std::string source_hash) {
+    if (!ases->empty())
+        return false;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(TopologySnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t file_size = st.st_size;
+    void *mapped = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return false;
+
+    // Check the header before touching the arrays
+    const TopologySnapshotHeader *header = static_cast<const TopologySnapshotHeader*>(mapped);
+    char expected_hash[TOPOLOGY_SNAPSHOT_HASH_SIZE] = {0};
+    memcpy(expected_hash, source_hash.data(), std::min(source_hash.size(), sizeof(expected_hash) - 1));
+    uint64_t num_ases = header->num_ases;
+    // Sum the array sizes without letting corrupt counts wrap around
+    uint64_t max_values = (file_size - sizeof(TopologySnapshotHeader)) / sizeof(uint32_t);
+    uint64_t num_values = 0;
+    bool fits = true;
+    auto add_values = [&](uint64_t count, uint64_t arrays) {
+        fits = fits && count <= (max_values - num_values) / arrays;
+        if (fits)
+            num_values += count * arrays;
+    };
+    add_values(num_ases, 2);
+    add_values(num_ases + 1, 3);
+    add_values(header->num_provider_edges, 1);
+    add_values(header->num_peer_edges, 1);
+    add_values(header->num_customer_edges, 1);
+    add_values(header->num_stubs, 2);
+    add_values(header->num_translations, 2);
+    add_values(header->num_non_stubs, 1);
+    if (strncmp(header->magic, TOPOLOGY_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != TOPOLOGY_SNAPSHOT_VERSION ||
+        header->header_size != sizeof(TopologySnapshotHeader) ||
+        memcmp(header->source_hash, expected_hash, sizeof(expected_hash)) != 0 ||
+        !fits || num_ases > UINT32_MAX ||
+        sizeof(TopologySnapshotHeader) + num_values * sizeof(uint32_t) != file_size) {
+        munmap(mapped, file_size);
+        return false;
+    }
+
+    // Walk the arrays in file order
+    const uint32_t *cursor = reinterpret_cast<const uint32_t*>(header + 1);
+    auto take = [&cursor](uint64_t count) {
+        const uint32_t *first = cursor;
+        cursor += count;
+        return first;
+    };
+    const uint32_t *asns = take(num_ases);
+    const uint32_t *ranks = take(num_ases);
+    CSRAdjacency *csrs[3] = {provider_csr, peer_csr, customer_csr};
+    uint64_t num_edges[3] = {header->num_provider_edges, header->num_peer_edges, header->num_customer_edges};
+    const uint32_t *offsets[3], *neighbors[3];
+    bool valid = true;
+    for (int r = 0; r < 3; r++) {
+        offsets[r] = take(num_ases + 1);
+        neighbors[r] = take(num_edges[r]);
+        // Reject rows that run past the end of their neighbor array
+        valid = valid && offsets[r][0] == 0 && offsets[r][num_ases] == num_edges[r];
+        for (uint64_t id = 0; valid && id < num_ases; id++)
+            valid = offsets[r][id] <= offsets[r][id + 1];
+        for (uint64_t e = 0; valid && e < num_edges[r]; e++)
+            valid = neighbors[r][e] < num_ases;
+    }
+    // Ranks size the rank buckets, and every provider must rank above its customers
+    for (uint64_t id = 0; valid && id < num_ases; id++)
+        valid = ranks[id] < num_ases;
+    for (uint64_t id = 0; valid && id < num_ases; id++) {
+        for (uint32_t e = offsets[0][id]; valid && e < offsets[0][id + 1]; e++)
+            valid = ranks[neighbors[0][e]] > ranks[id];
+    }
+    if (!valid) {
+        munmap(mapped, file_size);
+        return false;
+    }
+    const uint32_t *stubs = take(2 * header->num_stubs);
+    const uint32_t *translations = take(2 * header->num_translations);
+    const uint32_t *non_stub_asns = take(header->num_non_stubs);
+
+    // Recreate the ASes in id order
+    ases_by_id->clear();
+    ases_by_id->reserve(num_ases);
+    ases->reserve(num_ases);
+    uint32_t max_rank = 0;
+    for (uint32_t id = 0; id < num_ases; id++) {
+        ASType *as = create_as(asns[id]);
+        as->id = id;
+        as->rank = ranks[id];
+        max_rank = std::max(max_rank, ranks[id]);
+        ases->insert(std::pair<uint32_t, ASType*>(as->asn, as));
+        ases_by_id->push_back(as);
+    }
+
+    // Copy the adjacency arrays and mirror them into the relationship sets
+    for (int r = 0; r < 3; r++) {
+        csrs[r]->offsets.assign(offsets[r], offsets[r] + num_ases + 1);
+        csrs[r]->neighbors.assign(neighbors[r], neighbors[r] + num_edges[r]);
+    }
+    std::vector<uint32_t> row_asns;
+    for (ASType *as : *ases_by_id) {
+        std::set<uint32_t> *sets[3] = {as->providers, as->peers, as->customers};
+        // Rows are in propagation order, so sort a copy to append every insert at the end
+        for (int r = 0; r < 3; r++) {
+            row_asns.clear();
+            for (uint32_t neighbor_id : csrs[r]->row(as->id))
+                row_asns.push_back((*ases_by_id)[neighbor_id]->asn);
+            std::sort(row_asns.begin(), row_asns.end());
+            for (uint32_t asn : row_asns)
+                sets[r]->insert(sets[r]->end(), asn);
+        }
+    }
+
+    // Bucket ASes by rank, keeping id order within each rank
+    for (auto const& r : *ases_by_rank)
+        delete r;
+    ases_by_rank->clear();
+    for (uint32_t rank = 0; num_ases > 0 && rank <= max_rank; rank++)
+        ases_by_rank->push_back(new std::vector<uint32_t>());
+    for (uint32_t id = 0; id < num_ases; id++)
+        (*ases_by_rank)[ranks[id]]->push_back(id);
+
+    for (uint64_t i = 0; i < header->num_stubs; i++)
+        stubs_to_parents->insert(std::pair<uint32_t, uint32_t>(stubs[2 * i], stubs[2 * i + 1]));
+    for (uint64_t i = 0; i < header->num_translations; i++) {
+        uint32_t member_asn = translations[2 * i];
+        uint32_t supernode_asn = translations[2 * i + 1];
+        component_translation->insert(std::pair<uint32_t, uint32_t>(member_asn, supernode_asn));
+        auto supernode = ases->find(supernode_asn);
+        if (supernode != ases->end())
+            supernode->second->member_ases->push_back(member_asn);
+    }
+    non_stubs->assign(non_stub_asns, non_stub_asns + header->num_non_stubs);
+    index_non_stubs();
+
+    munmap(mapped, file_size);
+    return true;
+}
+
+template <class ASType>
+void BaseGraph<ASType>::find_components() {
+    if (scc_threads > 1)
+        parallel_scc(scc_threads);
+    else
+        tarjan();
+}
+
+template <class ASType>
+void BaseGraph<ASType>::tarjan() {
+    build_adjacency();
+    uint32_t num_ases = ases_by_id->size();
+    components->reset(num_ases, num_ases);
+
+    const uint32_t unvisited = UINT32_MAX;
+    std::vector<uint32_t> index(num_ases, unvisited);
+    std::vector<uint32_t> lowlink(num_ases, 0);
+    std::vector<bool> on_stack(num_ases, false);
+    std::vector<uint32_t> s;
+    std::vector<uint32_t> component;
+    // Explicit call stack of (AS id, position of its next provider edge)
+    std::vector<std::pair<uint32_t, uint32_t>> call_stack;
+    uint32_t next_index = 0;
+
+    for (uint32_t root = 0; root < num_ases; root++) {
+        if (index[root] != unvisited)
             continue;
-        
-        // Find indentifying ASN for supernode 
-        uint32_t combined_asn = component->at(0);
-        for (auto &cur_asn : *component)
-            if (cur_asn < combined_asn)
-                combined_asn = cur_asn;
-
-        // Combined Component will id as lowest ASN
-        // AS *combined_AS = new AS(combined_asn, inverse_results);
-        ASType *combined_AS = createNew(combined_asn);
-        
-        // For all members of a component, gather neighbors
-        for (auto &cur_asn : *component) {
-            combined_AS->member_ases->push_back(cur_asn);
-            // Get the AS object associated to ASN
-            auto asn_search = ases->find(cur_asn);
-            ASType *cur_AS = asn_search->second;
-
-            // Handle providers
-            for (auto &provider_asn : *cur_AS->providers) {
-                // Check if provider is in component
-                bool external = (std::find(component->begin(), 
-                                           component->end(), 
-                                           provider_asn) == component->end());
-                if (external) {
-                    ASType *provider_AS = ases->find(provider_asn)->second;
-                    // Add new relationship
-                    combined_AS->add_neighbor(provider_asn, AS_REL_PROVIDER);
-                    provider_AS->add_neighbor(combined_asn, AS_REL_CUSTOMER);
-                    // Handle overlapping peer, remove peer relationship from supernode
-                    combined_AS->remove_neighbor(provider_asn, AS_REL_PEER);
-                    // Remove old subnode customer relationship from external provider
-                    provider_AS->remove_neighbor(cur_asn, AS_REL_CUSTOMER);
-                    // Remove subnode peer relationship from external provider if it exists
-                    provider_AS->remove_neighbor(cur_asn, AS_REL_PEER);
+        index[root] = lowlink[root] = next_index++;
+        s.push_back(root);
+        on_stack[root] = true;
+        call_stack.push_back(std::make_pair(root, provider_csr->offsets[root]));
+
+        while (!call_stack.empty()) {
+            uint32_t v = call_stack.back().first;
+            uint32_t edge = call_stack.back().second;
+            if (edge < provider_csr->offsets[v + 1]) {
+                call_stack.back().second++;
+                uint32_t w = provider_csr->neighbors[edge];
+                if (index[w] == unvisited) {
+                    // Descend into the provider
+                    index[w] = lowlink[w] = next_index++;
+                    s.push_back(w);
+                    on_stack[w] = true;
+                    call_stack.push_back(std::make_pair(w, provider_csr->offsets[w]));
+                } else if (on_stack[w]) {
+                    lowlink[v] = std::min(lowlink[v], index[w]);
                 }
+                continue;
+            }
+
+            // All providers visited, return to the caller
+            call_stack.pop_back();
+            if (!call_stack.empty()) {
+                uint32_t parent = call_stack.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[v]);
             }
 
-            // Handle customers
-            for (auto &customer_asn : *cur_AS->customers) {
-                // Check if customer is in component
-                bool external = (std::find(component->begin(), 
-                                           component->end(), 
-                                           customer_asn) == component->end());
-                if (external) {
-                    ASType *customer_AS = ases->find(customer_asn)->second;
-                    // Add new relationship
-                    combined_AS->add_neighbor(customer_asn, AS_REL_CUSTOMER);
-                    customer_AS->add_neighbor(combined_asn, AS_REL_PROVIDER);
-                    // Handle overlapping peer, remove redundant peer relationship from supernode
-                    combined_AS->remove_neighbor(customer_asn, AS_REL_PEER);
-                    // Remove old subnode provider relationship from external provider
-                    customer_AS->remove_neighbor(cur_asn, AS_REL_PROVIDER);
-                    // Remove redundant subnode peer relationship from external provider if it exists
-                    customer_AS->remove_neighbor(cur_asn, AS_REL_PEER);
+            if (lowlink[v] == index[v]) {
+                component.clear();
+                uint32_t w;
+                do {
+                    w = s.back();
+                    s.pop_back();
+                    on_stack[w] = false;
+                    component.push_back((*ases_by_id)[w]->asn);
+                } while (w != v);
+                components->append_row(component);
+            }
+        }
+    }
+}
+
+template <class ASType>
+void BaseGraph<ASType>::parallel_scc(uint32_t num_threads) {
+    build_adjacency();
+    uint32_t num_ases = ases_by_id->size();
+    components->reset(num_ases, num_ases);
+
+    // Customers by provider, the reverse of the provider edges
+    CSRAdjacency reverse;
+    reverse.offsets.assign(num_ases + 1, 0);
+    for (uint32_t provider_id : provider_csr->neighbors)
+        reverse.offsets[provider_id + 1]++;
+    for (uint32_t id = 0; id < num_ases; id++)
+        reverse.offsets[id + 1] += reverse.offsets[id];
+    reverse.neighbors.resize(provider_csr->neighbors.size());
+    std::vector<uint32_t> fill(reverse.offsets.begin(), reverse.offsets.end() - 1);
+    for (uint32_t id = 0; id < num_ases; id++)
+        for (uint32_t provider_id : provider_csr->row(id))
+            reverse.neighbors[fill[provider_id]++] = id;
+
+    // Color of the subproblem each AS belongs to, done ASes are trimmed or emitted
+    const uint32_t done = UINT32_MAX;
+    std::unique_ptr<std::atomic<uint32_t>[]> color(new std::atomic<uint32_t>[num_ases]);
+    std::vector<std::vector<uint32_t>> found;
+
+    // Trim ASes that cannot be on a cycle, they are components of their own
+    std::vector<uint32_t> out_degree(num_ases), in_degree(num_ases);
+    std::vector<uint32_t> trimmed;
+    for (uint32_t id = 0; id < num_ases; id++) {
+        out_degree[id] = provider_csr->row(id).size();
+        in_degree[id] = reverse.row(id).size();
+        color[id] = 0;
+        if (out_degree[id] == 0 || in_degree[id] == 0) {
+            color[id] = done;
+            trimmed.push_back(id);
+        }
+    }
+    for (size_t next = 0; next < trimmed.size(); next++) {
+        uint32_t id = trimmed[next];
+        found.push_back(std::vector<uint32_t>(1, (*ases_by_id)[id]->asn));
+        for (uint32_t provider_id : provider_csr->row(id)) {
+            if (color[provider_id] != done && --in_degree[provider_id] == 0) {
+                color[provider_id] = done;
+                trimmed.push_back(provider_id);
+            }
+        }
+        for (uint32_t customer_id : reverse.row(id)) {
+            if (color[customer_id] != done && --out_degree[customer_id] == 0) {
+                color[customer_id] = done;
+                trimmed.push_back(customer_id);
+            }
+        }
+    }
+
+    // Everything left is in the first subproblem
+    std::deque<std::vector<uint32_t>> tasks;
+    std::vector<uint32_t> core;
+    for (uint32_t id = 0; id < num_ases; id++)
+        if (color[id] != done)
+            core.push_back(id);
+    if (!core.empty())
+        tasks.push_back(std::move(core));
+
+    std::mutex lock;
+    std::condition_variable wake;
+    uint32_t busy = 0;
+    std::atomic<uint32_t> next_color(1);
+    // Each AS belongs to exactly one task, so marks are only touched by its owner
+    std::vector<uint8_t> mark(num_ases, 0);
+
+    auto worker = [&]() {
+        std::vector<uint32_t> frontier;
+        while (true) {
+            std::vector<uint32_t> members;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&]() { return !tasks.empty() || busy == 0; });
+                if (tasks.empty())
+                    return;
+                members.swap(tasks.front());
+                tasks.pop_front();
+                busy++;
+            }
+            uint32_t c = color[members[0]];
+
+            // Mark everything reachable from the pivot, forward (1) and backward (2)
+            const CSRAdjacency *directions[2] = {provider_csr, &reverse};
+            for (uint8_t d = 0; d < 2; d++) {
+                uint8_t bit = 1 << d;
+                frontier.assign(1, members[0]);
+                mark[members[0]] |= bit;
+                while (!frontier.empty()) {
+                    uint32_t id = frontier.back();
+                    frontier.pop_back();
+                    for (uint32_t neighbor_id : directions[d]->row(id)) {
+                        if (color[neighbor_id] == c && !(mark[neighbor_id] & bit)) {
+                            mark[neighbor_id] |= bit;
+                            frontier.push_back(neighbor_id);
+                        }
+                    }
                 }
-            }   
-
-            // Handle peers
-            for (auto &peer_asn: *cur_AS->peers) {
-                // Check if peer is in component
-                bool external = (std::find(component->begin(), 
-                                      component->end(), 
-                                      peer_asn) == component->end());
-                // Check if peer is already a provider in the combined AS
-                bool no_provider_rel = (combined_AS->providers->find(peer_asn) ==
-                                        combined_AS->providers->end());
-                // Check if peer is already a customer in the combined AS
-                bool no_customer_rel = (combined_AS->customers->find(peer_asn) ==
-                                        combined_AS->customers->end());
-                
-                // Peer is safe to add to combined AS
-                if (external && no_provider_rel && no_customer_rel) {
-                    ASType *peer_AS = ases->find(peer_asn)->second;
-                    // Add new relationship
-                    combined_AS->add_neighbor(peer_asn, AS_REL_PEER);
-                    peer_AS->add_neighbor(combined_asn, AS_REL_PEER);
-                    // Remove old peer relation to the subnode
-                    peer_AS->remove_neighbor(cur_asn, AS_REL_PEER);
-                } else if (external) {
-                    // Other relationship superseeds peer
-                    ASType *peer_AS = ases->find(peer_asn)->second;
-                    // Remove the subnode peer relationship from the external node
-                    peer_AS->remove_neighbor(cur_asn, AS_REL_PEER);
+            }
+
+            // Reached both ways is the pivot's component, the rest splits three ways
+            std::vector<uint32_t> component;
+            std::vector<uint32_t> split[3];
+            for (uint32_t id : members) {
+                if (mark[id] == 3) {
+                    component.push_back((*ases_by_id)[id]->asn);
+                    color[id] = done;
+                } else {
+                    split[mark[id]].push_back(id);
                 }
+                mark[id] = 0;
             }
+            for (auto &part : split) {
+                if (part.empty())
+                    continue;
+                uint32_t part_color = next_color++;
+                for (uint32_t id : part)
+                    color[id] = part_color;
+            }
+
+            std::unique_lock<std::mutex> guard(lock);
+            found.push_back(component);
+            for (auto &part : split)
+                if (!part.empty())
+                    tasks.push_back(std::move(part));
+            busy--;
+            wake.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < num_threads; i++)
+        threads.push_back(std::thread(worker));
+    for (auto &t : threads)
+        t.join();
+
+    // Emit in a deterministic order
+    for (auto &component : found)
+        std::sort(component.begin(), component.end());
+    std::sort(found.begin(), found.end());
+    for (auto &component : found)
+        components->append_row(component);
+}
+
+template <class ASType>
+void BaseGraph<ASType>::combine_components() {
+    // ASN each AS will have after combining, indexed by the ids of find_components
+    uint32_t num_ases = ases_by_id->size();
+    std::vector<uint32_t> combined_asn(num_ases);
+    std::vector<bool> in_supernode(num_ases, false);
+    for (uint32_t id = 0; id < num_ases; id++)
+        combined_asn[id] = (*ases_by_id)[id]->asn;
+
+    // Supernodes are identified by their lowest ASN
+    std::vector<std::pair<uint32_t, uint32_t>> supernodes;   // (combined ASN, component)
+    for (uint32_t c = 0; c < components->num_rows(); c++) {
+        auto component = components->row(c);
+        // Ignore single AS nodes
+        if (component.size() <= 1)
+            continue;
+        uint32_t low = *std::min_element(component.begin(), component.end());
+        for (uint32_t member_asn : component) {
+            uint32_t id = ases->find(member_asn)->second->id;
+            combined_asn[id] = low;
+            in_supernode[id] = true;
+        }
+        supernodes.push_back(std::make_pair(low, c));
+    }
+    if (supernodes.empty())
+        return;
+
+    // Translate a CSR row into the ASNs after combining, skipping edges inside the supernode
+    auto translate_row = [&](CSRAdjacency::Row row, uint32_t self, std::set<uint32_t> &out) {
+        for (uint32_t neighbor_id : row)
+            if (combined_asn[neighbor_id] != self)
+                out.insert(combined_asn[neighbor_id]);
+    };
+    // Provider and customer relationships supersede peering
+    auto drop_overlapping_peers = [](ASType *as) {
+        for (auto it = as->peers->begin(); it != as->peers->end();) {
+            if (as->providers->count(*it) || as->customers->count(*it))
+                it = as->peers->erase(it);
+            else
+                ++it;
+        }
+    };
+
+    // Rewrite every external AS adjacent to a supernode in a single pass
+    for (uint32_t id = 0; id < num_ases; id++) {
+        if (in_supernode[id])
+            continue;
+        bool adjacent = false;
+        for (CSRAdjacency *csr : {provider_csr, peer_csr, customer_csr})
+            for (uint32_t neighbor_id : csr->row(id))
+                adjacent = adjacent || in_supernode[neighbor_id];
+        if (!adjacent)
+            continue;
+
+        ASType *as = (*ases_by_id)[id];
+        as->providers->clear();
+        as->peers->clear();
+        as->customers->clear();
+        translate_row(provider_csr->row(id), as->asn, *as->providers);
+        translate_row(peer_csr->row(id), as->asn, *as->peers);
+        translate_row(customer_csr->row(id), as->asn, *as->customers);
+        drop_overlapping_peers(as);
+    }
+
+    // Build each supernode from the union of its members' external relationships
+    for (auto &supernode : supernodes) {
+        ASType *combined_AS = create_as(supernode.first);
+        for (uint32_t member_asn : components->row(supernode.second)) {
+            auto member_search = ases->find(member_asn);
+            ASType *member_AS = member_search->second;
+            uint32_t id = member_AS->id;
+            translate_row(provider_csr->row(id), supernode.first, *combined_AS->providers);
+            translate_row(peer_csr->row(id), supernode.first, *combined_AS->peers);
+            translate_row(customer_csr->row(id), supernode.first, *combined_AS->customers);
+            combined_AS->member_ases->push_back(member_asn);
+            
             // Append ASN translation and discard member
-            component_translation->insert(std::pair<uint32_t, uint32_t>(cur_asn,combined_asn));
-            ases->erase(cur_AS->asn);
-            delete cur_AS;
+            component_translation->insert(std::pair<uint32_t, uint32_t>(member_asn, supernode.first));
+            ases->erase(member_search);
+            delete member_AS;
         }
+        drop_overlapping_peers(combined_AS);
         // Insert complete combined node to ases
-        ases->insert(std::pair<uint32_t, ASType*>(combined_asn,combined_AS));
+        ases->insert(std::pair<uint32_t, ASType*>(supernode.first, combined_AS));
     }
-    return;
+
+    // Member ids are stale until the adjacency is rebuilt
+    ases_by_id->clear();
 }
 
 template <class ASType>
@@ -17,21 +17,8 @@ EZAS* EZASGraph::createNew(uint32_t asn) {
 }
 
 void EZASGraph::disconnectAttackerEdges() {
-    for(auto pair : *attacker_edge_removal) {
-        EZAS* attacker = ases->find(pair.first)->second;
-        EZAS* provider = ases->find(pair.second)->second;
-
-        auto result = provider->customers->find(attacker->asn);
-
-        if(result != provider->customers->end()) {//most likely
-            provider->customers->erase(result);
-            attacker->providers->erase(provider->asn);
-        } else {//super uncommon
-            provider->peers->erase(attacker->asn);
-            attacker->peers->erase(provider->asn);
-        }
-    }
-
+    // Ranks and adjacency arrays are updated in place, so the graph stays ready for propagation
+    remove_relationships(*attacker_edge_removal);
     attacker_edge_removal->clear();
 }
 
@@ -67,7 +54,7 @@ void EZASGraph::distributeAttackersVictims(SQLQuerier* querier) {
 void EZASGraph::process(SQLQuerier* querier) {
     //We definately want stubs/edge ASes
     distributeAttackersVictims(querier);
-    tarjan();
+    find_components();
     combine_components();
     //Don't need to save super nodes
     decide_ranks();
@@ -21,6 +21,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  ************************************************************************/
 
+#include <stdexcept>
+
 #include "Graphs/ROVppASGraph.h"
 
 ROVppASGraph::ROVppASGraph() : BaseGraph(false, false) {
@@ -39,7 +41,7 @@ ROVppAS* ROVppASGraph::createNew(uint32_t asn) {
 
 void ROVppASGraph::process(SQLQuerier *querier) {
     // Main difference is remove_stubs isn't being called
-    tarjan();
+    find_components();
     combine_components();
     save_supernodes_to_db(querier);
     decide_ranks();
@@ -47,35 +49,23 @@ void ROVppASGraph::process(SQLQuerier *querier) {
 }
 
 void ROVppASGraph::create_graph_from_db(ROVppSQLQuerier *querier){
-    // Assemble Peers
-    pqxx::result R = querier->select_from_table(PEERS_TABLE);
-    for (pqxx::result::const_iterator c = R.begin(); c!=R.end(); ++c){
-        add_relationship(c["peer_as_1"].as<uint32_t>(),
-                         c["peer_as_2"].as<uint32_t>(),AS_REL_PEER);
-        add_relationship(c["peer_as_2"].as<uint32_t>(),
-                         c["peer_as_1"].as<uint32_t>(),AS_REL_PEER);
-    }
-    // Assemble Customer-Providers
-    R = querier->select_from_table(CUSTOMER_PROVIDER_TABLE);
-    for (pqxx::result::const_iterator c = R.begin(); c!=R.end(); ++c){
-        add_relationship(c["customer_as"].as<uint32_t>(),
-                         c["provider_as"].as<uint32_t>(),AS_REL_PROVIDER);
-        add_relationship(c["provider_as"].as<uint32_t>(),
-                         c["customer_as"].as<uint32_t>(),AS_REL_CUSTOMER);
-    }
+    // Assemble Peers and Customer-Providers
+    add_relationships_from_db(querier);
 
     // Assign policies to ASes
-    for (auto policy_table : querier->policy_tables) {
-        R = querier->select_AS_flags(policy_table);
+    std::vector<uint32_t> policies;     // Flat buffer of (asn, as_type) pairs
+    for (auto const& policy_table : querier->policy_tables) {
+        policies.clear();
+        if (!querier->copy_columns_from_db("SELECT asn, as_type FROM " + policy_table, 2, policies))
+            throw std::runtime_error("Failed to read policies from " + policy_table);
         // For each AS in the policy Table
-        for (pqxx::result::const_iterator c = R.begin(); c != R.end(); ++c) {
+        for (size_t i = 0; i + 1 < policies.size(); i += 2) {
             // Get the ASN for current AS
-            auto search = ases->find(c["asn"].as<uint32_t>());
+            auto search = ases->find(policies[i]);
             if (search != ases->end()) {
                 // Add the policy to AS
                 // TODO Handle "as_type" policy as an array
-                // dynamic_cast<ROVppAS*>(search->second)->add_policy(c["as_type"].as<uint32_t>());
-                search->second->add_policy(c["as_type"].as<uint32_t>());
+                search->second->add_policy(policies[i + 1]);
             }
         }
     }
@@ -137,7 +127,7 @@ void ROVppASGraph::to_graphviz(std::ostream &os, std::vector<uint32_t> asns) {
         for (auto ann : *as.loc_rib) {
             os << "dot.edge('" << ann.second.received_from_asn << "', '" << as.asn << "', " << 
             (as.pass_rov(ann.second) ? "color='blue'" : "color='red'")
-            << ", label='" << ann.second.prefix.to_cidr() << "')" << std::endl;
+            << ", label='" << PrefixTable::getInstance().cidr(ann.second.prefix_id) << "')" << std::endl;
             if (ann.second.received_from_asn != asn && ann.second.received_from_asn != 64514 && ann.second.received_from_asn != 64513 && ann.second.received_from_asn != 64512) {
                 to_graphviz_traceback(os, ann.second.received_from_asn, 0);
             }
@@ -165,7 +155,7 @@ void ROVppASGraph::to_graphviz_traceback(std::ostream &os, uint32_t asn, int dep
     for (auto ann : *as.loc_rib) {
         os << "dot.edge('" << ann.second.received_from_asn << "', '" << as.asn << "', " << 
         (ann.second.origin == 64512 ? "color='grey'" :  (as.pass_rov(ann.second) ? "color='blue'" : "color='red'"))
-        << ", label='" << ann.second.prefix.to_cidr() << "')" << std::endl;
+        << ", label='" << PrefixTable::getInstance().cidr(ann.second.prefix_id) << "')" << std::endl;
         if (ann.second.received_from_asn != asn && ann.second.received_from_asn != 64514 && ann.second.received_from_asn != 64513 && ann.second.received_from_asn != 64512 && depth < 3) {
             if (as.customers->find(ann.second.received_from_asn) != as.customers->end()) {
                 os << "dot.edge('" << as.asn << "', '" << ann.second.received_from_asn << "')" << std::endl;
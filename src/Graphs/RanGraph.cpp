@@ -31,8 +31,8 @@ ASGraph* ran_graph(int num_edges, int num_vertices) {
     i = 0;
     // Build a connection between two random vertex.
     while(i < num_edges) { 
-        // Provider = 0, Customer = 1
-        int rel_type = (rand() % 2) * 2;
+        // Provider or Customer
+        int rel_type = (rand() % 2) * AS_REL_CUSTOMER;
         
         // Generate two random vertices
         int to = rand() % num_vertices + 1;
@@ -43,7 +43,7 @@ ASGraph* ran_graph(int num_edges, int num_vertices) {
         
         // Add to graph
         graph->add_relationship(to, from, rel_type);
-        graph->add_relationship(from, to, 2 - rel_type);
+        graph->add_relationship(from, to, AS_REL_CUSTOMER - rel_type);
         i++;
     }
     return graph;
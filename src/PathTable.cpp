@@ -0,0 +1,106 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include "PathTable.h"
+
+const uint32_t PathTable::EMPTY_PATH;
+const uint32_t PathTable::CHUNK_BITS;
+const uint32_t PathTable::CHUNK_SIZE;
+const uint32_t PathTable::NUM_CHUNKS;
+
+PathTable& PathTable::getInstance() {
+    static PathTable instance;
+    return instance;
+}
+
+PathTable::PathTable() {
+    chunks = new std::atomic<Node*>[NUM_CHUNKS];
+    for (uint32_t i = 0; i < NUM_CHUNKS; i++)
+        chunks[i].store(NULL, std::memory_order_relaxed);
+    // The empty path is its own root
+    Node *chunk = new Node[CHUNK_SIZE];
+    chunk[EMPTY_PATH] = {0, EMPTY_PATH, 0};
+    chunks[0].store(chunk, std::memory_order_relaxed);
+    count = 1;
+}
+
+PathTable::~PathTable() {
+    for (uint32_t i = 0; i < NUM_CHUNKS; i++)
+        delete[] chunks[i].load(std::memory_order_relaxed);
+    delete[] chunks;
+}
+
+uint32_t PathTable::extend(uint32_t path, uint32_t asn) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto search = ids.find(key(path, asn));
+    if (search != ids.end())
+        return search->second;
+
+    uint32_t id = count;
+    Node *chunk = chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed);
+    if (chunk == NULL) {
+        chunk = new Node[CHUNK_SIZE];
+        chunks[id >> CHUNK_BITS].store(chunk, std::memory_order_release);
+    }
+    // Fill the node before the id escapes the lock
+    chunk[id & (CHUNK_SIZE - 1)] = {asn, path, node(path).length + 1};
+    count++;
+    ids.insert(std::make_pair(key(path, asn), id));
+    return id;
+}
+
+uint32_t PathTable::intern(const std::vector<uint32_t> &path) {
+    uint32_t id = EMPTY_PATH;
+    for (uint32_t asn : path)
+        id = extend(id, asn);
+    return id;
+}
+
+bool PathTable::contains(uint32_t path, uint32_t asn) const {
+    for (; path != EMPTY_PATH; path = node(path).parent) {
+        if (node(path).asn == asn)
+            return true;
+    }
+    return false;
+}
+
+std::vector<uint32_t> PathTable::materialize(uint32_t path) const {
+    // Walking the parents yields the path back to front
+    std::vector<uint32_t> hops(node(path).length);
+    for (auto it = hops.rbegin(); it != hops.rend(); ++it) {
+        *it = node(path).asn;
+        path = node(path).parent;
+    }
+    return hops;
+}
+
+void PathTable::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    ids.clear();
+    count = 1;
+}
+
+size_t PathTable::size() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return count;
+}
@@ -0,0 +1,111 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include "PrefixTable.h"
+
+const uint32_t PrefixTable::NO_PREFIX;
+const uint32_t PrefixTable::CHUNK_BITS;
+const uint32_t PrefixTable::CHUNK_SIZE;
+const uint32_t PrefixTable::NUM_CHUNKS;
+
+PrefixTable& PrefixTable::getInstance() {
+    static PrefixTable instance;
+    return instance;
+}
+
+PrefixTable::PrefixTable() {
+    chunks = new std::atomic<Entry*>[NUM_CHUNKS];
+    for (uint32_t i = 0; i < NUM_CHUNKS; i++)
+        chunks[i].store(NULL, std::memory_order_relaxed);
+    count = 0;
+}
+
+PrefixTable::~PrefixTable() {
+    for (uint32_t i = 0; i < NUM_CHUNKS; i++)
+        delete[] chunks[i].load(std::memory_order_relaxed);
+    delete[] chunks;
+}
+
+PrefixTable::Entry& PrefixTable::next_entry(uint32_t &id) {
+    id = count;
+    Entry *chunk = chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed);
+    if (chunk == NULL) {
+        chunk = new Entry[CHUNK_SIZE];
+        chunks[id >> CHUNK_BITS].store(chunk, std::memory_order_release);
+    }
+    count++;
+    return chunk[id & (CHUNK_SIZE - 1)];
+}
+
+uint32_t PrefixTable::intern(const Prefix<> &prefix) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto search = ids.find(key(prefix));
+    if (search != ids.end())
+        return search->second;
+
+    uint32_t id;
+    Entry &new_entry = next_entry(id);
+    // Fill the entry before the id escapes the lock
+    new_entry.prefix = prefix;
+    new_entry.cidr = prefix.to_cidr();
+    new_entry.ipv6 = false;
+    ids.insert(std::make_pair(key(prefix), id));
+    return id;
+}
+
+uint32_t PrefixTable::intern(const Prefix<unsigned __int128> &prefix) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto search = ids6.find(prefix);
+    if (search != ids6.end())
+        return search->second;
+
+    uint32_t id;
+    Entry &new_entry = next_entry(id);
+    // Fill the entry before the id escapes the lock
+    new_entry.prefix6 = prefix;
+    new_entry.cidr = prefix.to_cidr();
+    new_entry.ipv6 = true;
+    ids6.insert(std::make_pair(prefix, id));
+    return id;
+}
+
+uint32_t PrefixTable::lookup(const Prefix<> &prefix) const {
+    std::lock_guard<std::mutex> guard(lock);
+    auto search = ids.find(key(prefix));
+    if (search == ids.end())
+        return NO_PREFIX;
+    return search->second;
+}
+
+uint32_t PrefixTable::lookup(const Prefix<unsigned __int128> &prefix) const {
+    std::lock_guard<std::mutex> guard(lock);
+    auto search = ids6.find(prefix);
+    if (search == ids6.end())
+        return NO_PREFIX;
+    return search->second;
+}
+
+size_t PrefixTable::size() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return count;
+}
@@ -0,0 +1,121 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <cstdint>
+#include <cstring>
+#include <arpa/inet.h>
+
+#include "SQLQueriers/BinaryCopyDecoder.h"
+
+// Signature at the start of every binary COPY stream
+static const char COPY_SIGNATURE[] = "PGCOPY\n\377\r\n";
+static const size_t COPY_SIGNATURE_SIZE = 11;
+
+static uint16_t read_uint16(const char *p) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return ntohs(v);
+}
+
+static uint32_t read_uint32(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return ntohl(v);
+}
+
+BinaryCopyDecoder::BinaryCopyDecoder(uint32_t num_columns) {
+    this->num_columns = num_columns;
+    header_read = false;
+    trailer_read = false;
+}
+
+bool BinaryCopyDecoder::decode(const char *data, size_t size, std::vector<uint32_t> &values) {
+    const char *cur = data;
+    const char *end = data + size;
+
+    // Header: signature, flags, then a length-prefixed extension area
+    if (!header_read) {
+        if (size < COPY_SIGNATURE_SIZE + 8 || memcmp(cur, COPY_SIGNATURE, COPY_SIGNATURE_SIZE) != 0)
+            return false;
+        cur += COPY_SIGNATURE_SIZE + 4;
+        uint32_t extension_size = read_uint32(cur);
+        cur += 4;
+        if (extension_size > (size_t) (end - cur))
+            return false;
+        cur += extension_size;
+        header_read = true;
+    }
+
+    while (cur < end) {
+        if (end - cur < 2 || trailer_read)
+            return false;
+        int16_t num_fields = read_uint16(cur);
+        cur += 2;
+        // A field count of -1 marks the end of the data
+        if (num_fields == -1) {
+            trailer_read = true;
+            continue;
+        }
+        if (num_fields != (int32_t) num_columns)
+            return false;
+
+        size_t row_start = values.size();
+        bool has_null = false;
+        for (uint32_t f = 0; f < num_columns; f++) {
+            if (end - cur < 4)
+                return false;
+            int32_t field_size = read_uint32(cur);
+            cur += 4;
+            if (field_size == -1) {
+                has_null = true;
+                continue;
+            }
+            if (field_size > end - cur)
+                return false;
+            // Negative values cannot be ASNs, whatever the width of the column
+            if (field_size == 2) {
+                int16_t value = read_uint16(cur);
+                if (value < 0)
+                    return false;
+                values.push_back(value);
+            } else if (field_size == 4) {
+                int32_t value = read_uint32(cur);
+                if (value < 0)
+                    return false;
+                values.push_back(value);
+            } else if (field_size == 8) {
+                // A bigint must still fit in an unsigned 32-bit ASN
+                int64_t value = ((uint64_t) read_uint32(cur) << 32) | read_uint32(cur + 4);
+                if (value < 0 || value > UINT32_MAX)
+                    return false;
+                values.push_back(value);
+            } else {
+                return false;
+            }
+            cur += field_size;
+        }
+        if (has_null)
+            values.resize(row_start);
+    }
+    return true;
+}
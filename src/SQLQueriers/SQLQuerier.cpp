@@ -21,7 +21,10 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  ************************************************************************/
 
+#include <libpq-fe.h>
+
 #include "SQLQueriers/SQLQuerier.h"
+#include "SQLQueriers/BinaryCopyDecoder.h"
 
 SQLQuerier::SQLQuerier(std::string announcements_table /* = ANNOUNCEMENTS_TABLE */,
                         std::string results_table /* = RESULTS_TABLE */, 
@@ -99,15 +102,9 @@ void SQLQuerier::read_config() {
 /** Opens a connection to the SQL database.
  */
 void SQLQuerier::open_connection() {
-    std::ostringstream stream;
-    stream << "dbname = " << db_name;
-    stream << " user = " << user;
-    stream << " password = " << pass;
-    stream << " hostaddr = " << host;
-    stream << " port = " << port;
     // Try connecting with Querier object settings
     try {
-        pqxx::connection *conn = new pqxx::connection(stream.str());
+        pqxx::connection *conn = new pqxx::connection(connection_string());
         if (conn->is_open()) {
             std::cout << "Connected to database: " << db_name <<std::endl;
             C = conn;
@@ -121,6 +118,19 @@ void SQLQuerier::open_connection() {
 }
 
 
+/** Builds the connection string from the settings read by read_config.
+ */
+std::string SQLQuerier::connection_string() {
+    std::ostringstream stream;
+    stream << "dbname = " << db_name;
+    stream << " user = " << user;
+    stream << " password = " << pass;
+    stream << " hostaddr = " << host;
+    stream << " port = " << port;
+    return stream.str();
+}
+
+
 /** Closes the connection to the SQL database.
  */
 void SQLQuerier::close_connection() {
@@ -173,12 +183,80 @@ pqxx::result SQLQuerier::select_from_table(std::string table_name, int limit) {
 }
 
 
+/** Streams the integer columns of a query into a flat buffer with a binary COPY.
+ *
+ *  Rows are decoded as they arrive, so the result set is never held in memory
+ *  and no field is parsed from text. COPY runs on its own libpq connection 
+ *  because libpqxx does not expose binary COPY.
+ *
+ *  @param sql SELECT of integer columns only
+ *  @param num_columns Number of columns selected
+ *  @param values Buffer receiving num_columns values per row, rows with a NULL are skipped
+ *  @return true if the whole result was received
+ */
+bool SQLQuerier::copy_columns_from_db(std::string sql, uint32_t num_columns, std::vector<uint32_t> &values) {
+    PGconn *conn = PQconnectdb(connection_string().c_str());
+    if (PQstatus(conn) != CONNECTION_OK) {
+        std::cerr << PQerrorMessage(conn) << std::endl;
+        PQfinish(conn);
+        return false;
+    }
+
+    std::string copy_sql = "COPY (" + sql + ") TO STDOUT (FORMAT binary);";
+    PGresult *res = PQexec(conn, copy_sql.c_str());
+    bool ok = PQresultStatus(res) == PGRES_COPY_OUT;
+    PQclear(res);
+
+    BinaryCopyDecoder decoder(num_columns);
+    char *buffer;
+    int size;
+    // Keep reading after a bad row, the COPY must run to completion
+    while ((size = PQgetCopyData(conn, &buffer, 0)) > 0) {
+        ok = ok && decoder.decode(buffer, size, values);
+        PQfreemem(buffer);
+    }
+    // Collect the final status of the COPY
+    while ((res = PQgetResult(conn)) != NULL) {
+        ok = ok && PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+    }
+    ok = ok && decoder.finished();
+    if (!ok)
+        std::cerr << "Binary COPY failed for: " << sql << std::endl << PQerrorMessage(conn) << std::endl;
+    PQfinish(conn);
+    return ok;
+}
+
+
+/** Computes a content hash of the peers and customer-provider tables.
+ *
+ *  Rows are ordered before hashing, so the hash only changes with the relationships.
+ *
+ *  @return hex digest identifying the relationship data
+ */
+std::string SQLQuerier::select_relationships_hash() {
+    std::string sql = "SELECT md5((SELECT COALESCE(string_agg(peer_as_1::text || ',' || peer_as_2::text, ';' ORDER BY peer_as_1, peer_as_2), '') FROM " PEERS_TABLE ")";
+    sql += " || '|' || (SELECT COALESCE(string_agg(customer_as::text || ',' || provider_as::text, ';' ORDER BY customer_as, provider_as), '') FROM " CUSTOMER_PROVIDER_TABLE "));";
+    pqxx::result R = execute(sql);
+    if (R.empty() || R[0][0].is_null())
+        return "";
+    return R[0][0].as<std::string>();
+}
+
+
 /** Pulls the count for all announcements for the prefix.
  *
  * @param p The prefix for which we SELECT
  */
 pqxx::result SQLQuerier::select_prefix_count(Prefix<>* p) {
-    std::string cidr = p->to_cidr();
+    return select_prefix_count(p->to_cidr());
+}
+
+pqxx::result SQLQuerier::select_prefix_count(Prefix<unsigned __int128>* p) {
+    return select_prefix_count(p->to_cidr());
+}
+
+pqxx::result SQLQuerier::select_prefix_count(const std::string &cidr) {
     std::string sql = "SELECT COUNT(*) FROM " + announcements_table;
     sql += " WHERE prefix = \'" + cidr + "\';";
     return execute(sql);
@@ -190,7 +268,14 @@ pqxx::result SQLQuerier::select_prefix_count(Prefix<>* p) {
  * @param p The prefix for which we SELECT
  */
 pqxx::result SQLQuerier::select_prefix_ann(Prefix<>* p) {
-    std::string cidr = p->to_cidr();
+    return select_prefix_ann(p->to_cidr());
+}
+
+pqxx::result SQLQuerier::select_prefix_ann(Prefix<unsigned __int128>* p) {
+    return select_prefix_ann(p->to_cidr());
+}
+
+pqxx::result SQLQuerier::select_prefix_ann(const std::string &cidr) {
     std::string sql = "SELECT host(prefix), netmask(prefix), as_path, origin, time FROM " + announcements_table;
     sql += " WHERE prefix = \'" + cidr + "\';";
     return execute(sql);
@@ -198,11 +283,20 @@ pqxx::result SQLQuerier::select_prefix_ann(Prefix<>* p) {
 
 
 /** Pulls the count for all announcements for the prefixes contained within the passed subnet.
+ *
+ *  Containment never crosses address families, so ::/0 only counts IPv6 announcements.
  *
  * @param p The prefix defining the subnet
  */
 pqxx::result SQLQuerier::select_subnet_count(Prefix<>* p) {
-    std::string cidr = p->to_cidr();
+    return select_subnet_count(p->to_cidr());
+}
+
+pqxx::result SQLQuerier::select_subnet_count(Prefix<unsigned __int128>* p) {
+    return select_subnet_count(p->to_cidr());
+}
+
+pqxx::result SQLQuerier::select_subnet_count(const std::string &cidr) {
     std::string sql = "SELECT COUNT(*) FROM " + announcements_table;
     sql += " WHERE prefix <<= \'" + cidr + "\';";
     return execute(sql);
@@ -214,7 +308,14 @@ pqxx::result SQLQuerier::select_subnet_count(Prefix<>* p) {
  * @param p The prefix defining the subnet
  */
 pqxx::result SQLQuerier::select_subnet_ann(Prefix<>* p) {
-    std::string cidr = p->to_cidr();
+    return select_subnet_ann(p->to_cidr());
+}
+
+pqxx::result SQLQuerier::select_subnet_ann(Prefix<unsigned __int128>* p) {
+    return select_subnet_ann(p->to_cidr());
+}
+
+pqxx::result SQLQuerier::select_subnet_ann(const std::string &cidr) {
     std::string sql = "SELECT host(prefix), netmask(prefix), as_path, origin, time FROM " + announcements_table;
     sql += " WHERE prefix <<= \'" + cidr + "\';";
     return execute(sql);
@@ -23,6 +23,13 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <unistd.h>
 
 #include "Graphs/ASGraph.h"
 #include "ASes/AS.h"
@@ -132,6 +139,24 @@ bool test_decide_ranks(){
         std::cerr << "Number of ASes in ases_by_rank != total number of ASes." << std::endl;
         return false;
     }
+    if (graph.rank_widths() != std::vector<uint32_t>({4, 1, 1})) {
+        std::cerr << "Wrong rank widths." << std::endl;
+        return false;
+    }
+    // Ids are handed out rank by rank, in ASN order within each rank
+    uint32_t next_id = 0;
+    uint32_t prev_asn = 0;
+    for (auto set : *graph.ases_by_rank) {
+        prev_asn = 0;
+        for (uint32_t id : *set) {
+            AS *as = graph.ases_by_id->at(id);
+            if (id != next_id++ || as->id != id || as->asn < prev_asn) {
+                std::cerr << "Ids are not rank-major." << std::endl;
+                return false;
+            }
+            prev_asn = as->asn;
+        }
+    }
     if (graph.ases->find(1)->second->rank == 2 &&
         graph.ases->find(2)->second->rank == 0 &&
         graph.ases->find(3)->second->rank == 1 &&
@@ -143,6 +168,65 @@ bool test_decide_ranks(){
     return false;
 }
 
+/** Test flattening the relationship sets into CSR adjacency arrays of dense ids.
+ *  Horizontal lines are peer relationships, vertical lines are customer-provider
+ * 
+ *    1
+ *   / \
+ *  2   3--4
+ *     / \
+ *    5   6
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_build_adjacency(){
+    ASGraph graph = ASGraph(false, false);
+    graph.add_relationship(2, 1, AS_REL_PROVIDER);
+    graph.add_relationship(1, 2, AS_REL_CUSTOMER);
+    graph.add_relationship(3, 1, AS_REL_PROVIDER);
+    graph.add_relationship(1, 3, AS_REL_CUSTOMER);
+    graph.add_relationship(5, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 5, AS_REL_CUSTOMER);
+    graph.add_relationship(6, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 6, AS_REL_CUSTOMER);
+    graph.add_relationship(4, 3, AS_REL_PEER);
+    graph.add_relationship(3, 4, AS_REL_PEER);
+    // Builds the adjacency arrays
+    graph.decide_ranks();
+
+    if (graph.provider_csr->num_rows() != 6 ||
+        graph.peer_csr->num_rows() != 6 ||
+        graph.customer_csr->num_rows() != 6) {
+        std::cerr << "Wrong number of rows in adjacency arrays." << std::endl;
+        return false;
+    }
+    // Every row must match the relationship sets of its AS
+    for (auto &as : *graph.ases) {
+        if (graph.ases_by_id->at(as.second->id) != as.second) {
+            std::cerr << "AS " << as.first << " is not stored under its id." << std::endl;
+            return false;
+        }
+        std::vector<CSRAdjacency*> csrs = {graph.provider_csr, graph.peer_csr, graph.customer_csr};
+        std::vector<std::set<uint32_t>*> sets = {as.second->providers, as.second->peers, as.second->customers};
+        for (size_t i = 0; i < csrs.size(); i++) {
+            std::set<uint32_t> row_asns;
+            for (uint32_t id : csrs[i]->row(as.second->id))
+                row_asns.insert(graph.ases_by_id->at(id)->asn);
+            if (row_asns != *sets[i]) {
+                std::cerr << "Adjacency row for AS " << as.first << " does not match its sets." << std::endl;
+                return false;
+            }
+        }
+    }
+    
+    auto customers = graph.customer_csr->row(graph.ases->find(3)->second->id);
+    if (customers.size() != 2) {
+        std::cerr << "Wrong customers for AS 3." << std::endl;
+        return false;
+    }
+    return true;
+}
+
 /** Test removing stub ASes from the graph. 
  * 
  *    1
@@ -214,12 +298,12 @@ bool test_tarjan(){ // includes tarjan_helper()
     graph.add_relationship(4, 3, AS_REL_PEER);
     graph.add_relationship(3, 4, AS_REL_PEER);
     graph.tarjan();
-    if (graph.components->size() != 4) {
+    if (graph.components->num_rows() != 4) {
         return false;
     }
     // Verify the cycle was detected
-    for (auto const& c : *graph.components) {
-        if (c->size() > 1 && c->size() != 3)
+    for (uint32_t c = 0; c < graph.components->num_rows(); c++) {
+        if (graph.components->row(c).size() > 1 && graph.components->row(c).size() != 3)
             return false;
     }   
      
@@ -244,12 +328,12 @@ bool test_tarjan(){ // includes tarjan_helper()
     graph2.add_relationship(14, 11, AS_REL_PEER);
     graph2.tarjan();
     
-    if (graph2.components->size() != 2) {
+    if (graph2.components->num_rows() != 2) {
         return false;
     }
     // Verify the cycle was detected
-    for (auto const& c : *graph2.components) {
-        if (c->size() > 1 && c->size() != 3)
+    for (uint32_t c = 0; c < graph2.components->num_rows(); c++) {
+        if (graph2.components->row(c).size() > 1 && graph2.components->row(c).size() != 3)
             return false;
     }
    
@@ -262,8 +346,8 @@ bool test_tarjan(){ // includes tarjan_helper()
         bool tarjan_cyclic = false;
         bool cyclic = is_cyclic(graph3);
         if (cyclic) {
-            for (auto &component : *graph3->components) {
-               if (component->size() > 1) {
+            for (uint32_t c = 0; c < graph3->components->num_rows(); c++) {
+               if (graph3->components->row(c).size() > 1) {
                   tarjan_cyclic = true;
                }
             }
@@ -276,6 +360,58 @@ bool test_tarjan(){ // includes tarjan_helper()
         //graph3->decide_ranks();
         delete graph3;
     }
+    
+    // A long provider chain closed into one cycle must not overflow the stack
+    ASGraph graph4 = ASGraph(false, false);
+    uint32_t chain_length = 500000;
+    for (uint32_t asn = 1; asn < chain_length; asn++) {
+        graph4.add_relationship(asn, asn + 1, AS_REL_PROVIDER);
+        graph4.add_relationship(asn + 1, asn, AS_REL_CUSTOMER);
+    }
+    graph4.add_relationship(chain_length, 1, AS_REL_PROVIDER);
+    graph4.add_relationship(1, chain_length, AS_REL_CUSTOMER);
+    graph4.tarjan();
+    if (graph4.components->num_rows() != 1 || 
+        graph4.components->row(0).size() != chain_length) {
+        std::cerr << "Long provider cycle was not detected." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Test that the parallel forward-backward algorithm finds the same 
+ *  components as Tarjan on random graphs.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_parallel_scc(){
+    // Components as sorted sets of ASNs, independent of emission order
+    auto component_sets = [](CSRAdjacency *components) {
+        std::set<std::vector<uint32_t>> sets;
+        for (uint32_t c = 0; c < components->num_rows(); c++) {
+            auto row = components->row(c);
+            std::vector<uint32_t> members(row.begin(), row.end());
+            std::sort(members.begin(), members.end());
+            sets.insert(members);
+        }
+        return sets;
+    };
+
+    for (int i = 0; i < 50; i++) {
+        // Fixed seeds keep any failure reproducible
+        unsigned int seed = 17 + i;
+        srand(seed);
+        ASGraph *graph = ran_graph(200, 100);
+        graph->tarjan();
+        auto expected = component_sets(graph->components);
+        graph->parallel_scc(4);
+        auto found = component_sets(graph->components);
+        delete graph;
+        if (expected != found) {
+            std::cerr << "Parallel components differ from Tarjan with seed " << seed << "." << std::endl;
+            return false;
+        }
+    }
     return true;
 }
 
@@ -414,5 +550,336 @@ bool test_combine_components(){
         std::cerr << "Incorrect supernode peer set." << std::endl;
         return false;
     }
+
+    // Random graphs must collapse into a consistent DAG
+    for (int i = 0; i < 50; i++) {
+        unsigned int seed = 23 + i;
+        srand(seed);
+        ASGraph *graph3 = ran_graph(300, 100);
+        graph3->tarjan();
+        graph3->combine_components();
+        bool consistent = !is_cyclic(graph3);
+        for (auto &as : *graph3->ases) {
+            for (uint32_t provider_asn : *as.second->providers) {
+                auto search = graph3->ases->find(provider_asn);
+                consistent = consistent && provider_asn != as.first && search != graph3->ases->end() &&
+                             search->second->customers->count(as.first);
+            }
+            for (uint32_t peer_asn : *as.second->peers) {
+                auto search = graph3->ases->find(peer_asn);
+                consistent = consistent && peer_asn != as.first && search != graph3->ases->end() &&
+                             search->second->peers->count(as.first) &&
+                             !as.second->providers->count(peer_asn) &&
+                             !as.second->customers->count(peer_asn);
+            }
+        }
+        delete graph3;
+        if (!consistent) {
+            std::cerr << "Combined random graph is inconsistent with seed " << seed << "." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Test writing a processed graph to a topology snapshot and loading it back.
+ *  Horizontal lines are peer relationships, vertical lines are customer-provider
+ * 
+ *        7
+ *        |
+ *        1
+ *     /  |  \
+ * 8--2 ->3-- 4
+ *       / \
+ *      5   6
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_topology_snapshot(){
+    ASGraph graph = ASGraph(false, false);
+    // Cycle 1->2->3->1
+    graph.add_relationship(2, 1, AS_REL_PROVIDER);
+    graph.add_relationship(1, 2, AS_REL_CUSTOMER);
+    graph.add_relationship(3, 2, AS_REL_PROVIDER);
+    graph.add_relationship(2, 3, AS_REL_CUSTOMER);
+    graph.add_relationship(1, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 1, AS_REL_CUSTOMER);
+    graph.add_relationship(1, 7, AS_REL_PROVIDER);
+    graph.add_relationship(7, 1, AS_REL_CUSTOMER);
+    graph.add_relationship(4, 1, AS_REL_PROVIDER);
+    graph.add_relationship(1, 4, AS_REL_CUSTOMER);
+    graph.add_relationship(5, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 5, AS_REL_CUSTOMER);
+    graph.add_relationship(6, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 6, AS_REL_CUSTOMER);
+    graph.add_relationship(4, 3, AS_REL_PEER);
+    graph.add_relationship(3, 4, AS_REL_PEER);
+    graph.add_relationship(8, 2, AS_REL_PEER);
+    graph.add_relationship(2, 8, AS_REL_PEER);
+    // Stand-ins for the results of remove_stubs
+    graph.stubs_to_parents->insert(std::pair<uint32_t, uint32_t>(9, 5));
+    graph.non_stubs->push_back(1);
+    graph.non_stubs->push_back(4);
+    graph.tarjan();
+    graph.combine_components();
+    graph.decide_ranks();
+
+    // A unique file, so concurrent runs and stale snapshots cannot interfere
+    char path_template[] = "/tmp/bgp_topology_snapshot_test_XXXXXX";
+    int fd = mkstemp(path_template);
+    if (fd < 0) {
+        std::cerr << "Failed to create a topology snapshot file." << std::endl;
+        return false;
+    }
+    close(fd);
+    std::string path = path_template;
+    // Removes the snapshot on every return below
+    struct RemoveFile {
+        std::string path;
+        ~RemoveFile() { std::remove(path.c_str()); }
+    } remove_snapshot = {path};
+
+    if (!graph.save_snapshot(path, "abc123")) {
+        std::cerr << "Failed to save topology snapshot." << std::endl;
+        return false;
+    }
+
+    // A snapshot of different relationship data must be rejected
+    ASGraph stale = ASGraph(false, false);
+    if (stale.load_snapshot(path, "def456") || !stale.ases->empty()) {
+        std::cerr << "Loaded a topology snapshot with the wrong hash." << std::endl;
+        return false;
+    }
+
+    ASGraph loaded = ASGraph(false, false);
+    if (!loaded.load_snapshot(path, "abc123")) {
+        std::cerr << "Failed to load topology snapshot." << std::endl;
+        return false;
+    }
+
+    if (loaded.ases->size() != graph.ases->size() ||
+        loaded.rank_widths() != graph.rank_widths() ||
+        *loaded.stubs_to_parents != *graph.stubs_to_parents ||
+        *loaded.component_translation != *graph.component_translation ||
+        *loaded.non_stubs != *graph.non_stubs) {
+        std::cerr << "Loaded topology snapshot does not match the graph." << std::endl;
+        return false;
+    }
+    std::vector<CSRAdjacency*> csrs = {graph.provider_csr, graph.peer_csr, graph.customer_csr};
+    std::vector<CSRAdjacency*> loaded_csrs = {loaded.provider_csr, loaded.peer_csr, loaded.customer_csr};
+    for (size_t i = 0; i < csrs.size(); i++) {
+        if (csrs[i]->offsets != loaded_csrs[i]->offsets ||
+            csrs[i]->neighbors != loaded_csrs[i]->neighbors) {
+            std::cerr << "Loaded adjacency arrays do not match the graph." << std::endl;
+            return false;
+        }
+    }
+    for (auto &as : *graph.ases) {
+        AS *copy = loaded.ases->find(as.first)->second;
+        if (copy->id != as.second->id || copy->rank != as.second->rank ||
+            *copy->providers != *as.second->providers ||
+            *copy->peers != *as.second->peers ||
+            *copy->customers != *as.second->customers ||
+            copy->member_ases->size() != as.second->member_ases->size()) {
+            std::cerr << "Loaded AS " << as.first << " does not match the graph." << std::endl;
+            return false;
+        }
+    }
+
+    // Corrupt snapshots must be rejected before any AS is created
+    std::ifstream infile(path, std::ios::binary);
+    std::string original((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    infile.close();
+    TopologySnapshotHeader header;
+    memcpy(&header, original.data(), sizeof(header));
+    size_t ranks_offset = sizeof(header) + header.num_ases * sizeof(uint32_t);
+    auto rejects = [&path](const std::string &contents) {
+        std::ofstream outfile(path, std::ios::binary | std::ios::trunc);
+        outfile.write(contents.data(), contents.size());
+        outfile.close();
+        ASGraph corrupt = ASGraph(false, false);
+        return !corrupt.load_snapshot(path, "abc123") && corrupt.ases->empty();
+    };
+    // A rank far past the number of ASes
+    std::string bad_rank = original;
+    uint32_t huge_rank = 0xFFFFFFF0;
+    memcpy(&bad_rank[ranks_offset], &huge_rank, sizeof(huge_rank));
+    // Every AS at rank 0, so providers no longer rank above their customers
+    std::string flat_ranks = original;
+    memset(&flat_ranks[ranks_offset], 0, header.num_ases * sizeof(uint32_t));
+    // Counts whose total wraps around to the real size of the arrays
+    std::string wrapped_counts = original;
+    TopologySnapshotHeader wrapped = header;
+    wrapped.num_stubs += (uint64_t) 1 << 63;
+    memcpy(&wrapped_counts[0], &wrapped, sizeof(wrapped));
+    if (!rejects(bad_rank) || !rejects(flat_ranks) || !rejects(wrapped_counts)) {
+        std::cerr << "Loaded a corrupt topology snapshot." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Test building the graph from a CAIDA as-rel file.
+ *  Horizontal lines are peer relationships, vertical lines are customer-provider
+ * 
+ *    1
+ *   / \
+ *  2   3--4
+ *     / \
+ *    5   6
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_create_graph_from_file(){
+    std::string path = "/tmp/bgp_as_rel_test.txt";
+    std::ofstream outfile(path);
+    outfile << "# source:topology|BGP\n"
+            << "1|2|-1\n"
+            << "1|3|-1|bgp\n"
+            << "3|5|-1\r\n"
+            << "3|6|-1\n"
+            << "\n"
+            << "3|4|0\n"
+            << "3|7|2\n"
+            << "8|9\n"
+            << "3|10|-1x\n"
+            << "99999999999|3|0";
+    outfile.close();
+
+    ASGraph graph = ASGraph(false, false);
+    bool ok = graph.add_relationships_from_file(path);
+    std::remove(path.c_str());
+    if (!ok) {
+        std::cerr << "Failed to read as-rel file." << std::endl;
+        return false;
+    }
+
+    // Malformed lines must not add any AS
+    ASGraph expected = ASGraph(false, false);
+    expected.add_relationship(2, 1, AS_REL_PROVIDER);
+    expected.add_relationship(1, 2, AS_REL_CUSTOMER);
+    expected.add_relationship(3, 1, AS_REL_PROVIDER);
+    expected.add_relationship(1, 3, AS_REL_CUSTOMER);
+    expected.add_relationship(5, 3, AS_REL_PROVIDER);
+    expected.add_relationship(3, 5, AS_REL_CUSTOMER);
+    expected.add_relationship(6, 3, AS_REL_PROVIDER);
+    expected.add_relationship(3, 6, AS_REL_CUSTOMER);
+    expected.add_relationship(4, 3, AS_REL_PEER);
+    expected.add_relationship(3, 4, AS_REL_PEER);
+    if (graph.ases->size() != expected.ases->size()) {
+        std::cerr << "Wrong number of ASes read from as-rel file." << std::endl;
+        return false;
+    }
+
+    // The file graph must go through the same processing
+    graph.process(NULL);
+    expected.process(NULL);
+    if (*graph.stubs_to_parents != *expected.stubs_to_parents ||
+        graph.rank_widths() != expected.rank_widths() ||
+        graph.ases->size() != 3) {
+        std::cerr << "Processed as-rel graph does not match." << std::endl;
+        return false;
+    }
+    for (auto &as : *expected.ases) {
+        auto search = graph.ases->find(as.first);
+        if (search == graph.ases->end() ||
+            search->second->rank != as.second->rank ||
+            *search->second->providers != *as.second->providers ||
+            *search->second->peers != *as.second->peers ||
+            *search->second->customers != *as.second->customers) {
+            std::cerr << "AS " << as.first << " read from as-rel file does not match." << std::endl;
+            return false;
+        }
+    }
+
+    // A missing file must stop graph construction instead of leaving an empty graph
+    ASGraph missing = ASGraph(false, false);
+    try {
+        missing.create_graph_from_file(path, NULL);
+        std::cerr << "Built a graph from a missing as-rel file." << std::endl;
+        return false;
+    } catch (const std::runtime_error &e) { }
+    return true;
+}
+
+/** Test removing relationships from a processed graph.
+ *  Ranks and adjacency arrays maintained in place must match a graph 
+ *  that is ranked again from scratch.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_remove_relationships(){
+    for (int i = 0; i < 20; i++) {
+        unsigned int seed = 29 + i;
+        srand(seed);
+        ASGraph *graph = ran_graph(600, 200);
+        srand(seed);
+        ASGraph *expected = ran_graph(600, 200);
+        for (ASGraph *g : {graph, expected}) {
+            g->tarjan();
+            g->combine_components();
+            g->decide_ranks();
+        }
+
+        // Disconnect random neighbors of random ASes
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        for (int e = 0; e < 60; e++) {
+            AS *as = graph->ases_by_id->at(rand() % graph->ases_by_id->size());
+            std::vector<uint32_t> neighbors(as->providers->begin(), as->providers->end());
+            neighbors.insert(neighbors.end(), as->peers->begin(), as->peers->end());
+            neighbors.insert(neighbors.end(), as->customers->begin(), as->customers->end());
+            if (!neighbors.empty())
+                edges.push_back(std::make_pair(as->asn, neighbors[rand() % neighbors.size()]));
+        }
+        graph->remove_relationships(edges);
+        for (auto &edge : edges) {
+            AS *first = expected->ases->find(edge.first)->second;
+            AS *second = expected->ases->find(edge.second)->second;
+            for (AS *as : {first, second}) {
+                AS *other = (as == first) ? second : first;
+                as->providers->erase(other->asn);
+                as->peers->erase(other->asn);
+                as->customers->erase(other->asn);
+            }
+        }
+        expected->decide_ranks();
+
+        // Ranks must hold the same ASes in the same order
+        bool consistent = graph->ases_by_rank->size() == expected->ases_by_rank->size();
+        for (size_t r = 0; consistent && r < graph->ases_by_rank->size(); r++) {
+            std::vector<uint32_t> *rank = graph->ases_by_rank->at(r);
+            std::vector<uint32_t> *expected_rank = expected->ases_by_rank->at(r);
+            consistent = rank->size() == expected_rank->size();
+            for (size_t k = 0; consistent && k < rank->size(); k++) {
+                AS *as = graph->ases_by_id->at(rank->at(k));
+                consistent = as->asn == expected->ases_by_id->at(expected_rank->at(k))->asn &&
+                             as->rank == (int) r;
+            }
+        }
+        // Adjacency rows must list the same neighbors in the same order
+        for (auto &as : *expected->ases) {
+            AS *updated = graph->ases->find(as.first)->second;
+            std::vector<CSRAdjacency*> csrs = {graph->provider_csr, graph->peer_csr, graph->customer_csr};
+            std::vector<CSRAdjacency*> expected_csrs = {expected->provider_csr, expected->peer_csr, expected->customer_csr};
+            for (size_t c = 0; consistent && c < csrs.size(); c++) {
+                auto row = csrs[c]->row(updated->id);
+                auto expected_row = expected_csrs[c]->row(as.second->id);
+                consistent = row.size() == expected_row.size();
+                for (uint32_t k = 0; consistent && k < row.size(); k++)
+                    consistent = graph->ases_by_id->at(row.begin()[k])->asn == 
+                                 expected->ases_by_id->at(expected_row.begin()[k])->asn;
+            }
+            consistent = consistent && *updated->providers == *as.second->providers &&
+                         *updated->peers == *as.second->peers &&
+                         *updated->customers == *as.second->customers;
+        }
+        delete graph;
+        delete expected;
+        if (!consistent) {
+            std::cerr << "Incremental relationship removal does not match reprocessing with seed " 
+                      << seed << "." << std::endl;
+            return false;
+        }
+    }
     return true;
 }
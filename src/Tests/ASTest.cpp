@@ -21,7 +21,10 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  ************************************************************************/
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
+#include <vector>
 #include "ASes/AS.h"
 #include "Announcements/Announcement.h"
 
@@ -103,17 +106,16 @@ bool test_receive_announcements(){
     vect.push_back(ann);
     // this function should make a copy of the announcement
     // if it does not, it is incorrect
-    Prefix<> old_prefix = ann.prefix;
-    ann.prefix.addr = 0x321C9F00;
-    ann.prefix.netmask = 0xFFFFFF00;
-    Prefix<> new_prefix = ann.prefix;
+    Prefix<> old_prefix = ann.prefix();
+    ann.prefix_id = PrefixTable::getInstance().intern(Prefix<>(0x321C9F00, 0xFFFFFF00));
+    Prefix<> new_prefix = ann.prefix();
     vect.push_back(ann);
     AS as = AS();
     as.receive_announcements(vect);
     if (as.incoming_announcements->size() != 2) { return false; }
     // order really doesn't matter here
     for (Announcement a : *as.incoming_announcements) {
-        if (a.prefix != old_prefix && a.prefix != new_prefix) {
+        if (a.prefix() != old_prefix && a.prefix() != new_prefix) {
             return false;
         }
     }
@@ -130,13 +132,12 @@ bool test_process_announcement(){
     // if it does not, it is incorrect
     AS as = AS(0, true);
     as.process_announcement(ann, true);
-    Prefix<> old_prefix = ann.prefix;
-    ann.prefix.addr = 0x321C9F00;
-    ann.prefix.netmask = 0xFFFFFF00;
-    Prefix<> new_prefix = ann.prefix;
+    Prefix<> old_prefix = ann.prefix();
+    ann.prefix_id = PrefixTable::getInstance().intern(Prefix<>(0x321C9F00, 0xFFFFFF00));
+    Prefix<> new_prefix = ann.prefix();
     as.process_announcement(ann, true);
-    if (new_prefix != as.all_anns->find(ann.prefix)->second.prefix ||
-        old_prefix != as.all_anns->find(old_prefix)->second.prefix) {
+    if (new_prefix != as.all_anns->find(ann.prefix())->second.prefix() ||
+        old_prefix != as.all_anns->find(old_prefix)->second.prefix()) {
         return false;
     }
 
@@ -147,7 +148,7 @@ bool test_process_announcement(){
     as.process_announcement(a1, true);
     as.process_announcement(a2, true);
     if (as.all_anns->find(p)->second.received_from_asn != 223 ||
-        as.depref_anns->find(p)->second.received_from_asn != 222) {
+        as.all_anns->depref(as.all_anns->find(p))->received_from_asn != 222) {
         std::cerr << "Failed best path inference priority check." << std::endl;
         return false;
     }    
@@ -156,7 +157,7 @@ bool test_process_announcement(){
     Announcement a3 = Announcement(111, p.addr, p.netmask, 299, 224, false);
     as.process_announcement(a3, true);
     if (as.all_anns->find(p)->second.received_from_asn != 224 ||
-        as.depref_anns->find(p)->second.received_from_asn != 223) {
+        as.all_anns->depref(as.all_anns->find(p))->received_from_asn != 223) {
         std::cerr << "Failed best path priority correction check." << std::endl;
         return false;
     } 
@@ -175,9 +176,9 @@ bool test_process_announcement(){
  */
 bool test_process_announcements(){
     Announcement ann1 = Announcement(13796, 0x89630000, 0xFFFF0000, 22742);
-    Prefix<> ann1_prefix = ann1.prefix;
+    Prefix<> ann1_prefix = ann1.prefix();
     Announcement ann2 = Announcement(13796, 0x321C9F00, 0xFFFFFF00, 22742);
-    Prefix<> ann2_prefix = ann2.prefix;
+    Prefix<> ann2_prefix = ann2.prefix();
     AS as = AS();
     // build a vector of announcements
     std::vector<Announcement> vect = std::vector<Announcement>();
@@ -275,3 +276,195 @@ bool test_already_received(){
     }
     return false;
 }
+
+/** Test the flat RIB against std::map under random inserts, erases and clears.
+ *
+ * @return true if successful.
+ */
+bool test_rib(){
+    // Depref slots must follow their entry when erasing moves entries around
+    RIB<Announcement> rib(true);
+    std::map<uint32_t, uint32_t> expected;
+    std::minstd_rand gen(17);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 5000; i++) {
+            // Small key space so probe chains collide and entries are revisited
+            uint32_t p = PrefixTable::getInstance().intern(Prefix<>(gen() % 700 << 8, 0xFFFFFF00));
+            uint32_t origin = gen() % 1000;
+            switch (gen() % 4) {
+                case 0: {
+                    size_t removed = rib.erase(p);
+                    if (removed != expected.erase(p)) {
+                        return false;
+                    }
+                    break;
+                }
+                case 1: {
+                    auto search = rib.find(p);
+                    if (search != rib.end()) {
+                        search = rib.erase(search);
+                        expected.erase(p);
+                    }
+                    break;
+                }
+                default: {
+                    Announcement ann(origin, PrefixTable::getInstance().prefix(p).addr, PrefixTable::getInstance().prefix(p).netmask, 0);
+                    auto result = rib.insert(std::pair<uint32_t, Announcement>(p, ann));
+                    bool inserted = expected.insert(std::make_pair(p, origin)).second;
+                    if (result.second != inserted || result.first->first != p) {
+                        return false;
+                    }
+                    if (inserted) {
+                        if (rib.depref(result.first) != NULL) {
+                            return false;
+                        }
+                        ann.origin += 1000;
+                        rib.set_depref(result.first, ann);
+                    }
+                }
+            }
+        }
+        if (rib.size() != expected.size()) {
+            return false;
+        }
+        for (auto &entry : expected) {
+            auto search = rib.find(entry.first);
+            if (search == rib.end() || search->second.origin != entry.second ||
+                rib.depref(search) == NULL || rib.depref(search)->origin != entry.second + 1000) {
+                return false;
+            }
+        }
+        size_t visited = 0;
+        for (auto &entry : rib) {
+            if (expected.find(entry.first) == expected.end()) {
+                return false;
+            }
+            visited++;
+        }
+        if (visited != expected.size()) {
+            return false;
+        }
+        // Reuse the table after a reset
+        rib.clear();
+        expected.clear();
+        if (!rib.empty() || rib.find(Prefix<>(0, 0xFFFFFF00)) != rib.end()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Test announcement storage drawn from an arena across two blocks.
+ *
+ * @return true if successful.
+ */
+bool test_arena(){
+    Arena arena(4096);
+    // Allocations are aligned, and larger than a chunk get their own
+    for (size_t alignment : {1, 4, 8, 16}) {
+        void *p = arena.allocate(3, alignment);
+        if (reinterpret_cast<uintptr_t>(p) % alignment != 0) {
+            return false;
+        }
+    }
+    arena.allocate(10000, 8);
+    arena.reset();
+    if (arena.bytes_in_use() != 0 || arena.high_water_mark() < 10000) {
+        return false;
+    }
+
+    AS as = AS(1, true);
+    as.use_arena(&arena);
+    size_t reserved = 0;
+    for (int block = 0; block < 2; block++) {
+        for (uint32_t i = 0; i < 1000; i++) {
+            Announcement ann = Announcement(13796, i << 8, 0xFFFFFF00, 22742);
+            as.process_announcement(ann, false);
+        }
+        if (as.all_anns->size() != 1000 || arena.bytes_in_use() == 0 ||
+            as.all_anns->find(Prefix<>(999 << 8, 0xFFFFFF00)) == as.all_anns->end()) {
+            return false;
+        }
+        // The second block must fit in the chunks kept from the first
+        if (block == 1 && arena.bytes_reserved() != reserved) {
+            return false;
+        }
+        reserved = arena.bytes_reserved();
+        as.clear_announcements();
+        arena.reset();
+        if (!as.all_anns->empty() || arena.bytes_in_use() != 0) {
+            return false;
+        }
+    }
+
+    // Threads allocating at once get disjoint memory from their own regions
+    const size_t per_thread = 1000;
+    std::vector<std::vector<uint32_t*>> blocks(4);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < blocks.size(); t++) {
+        threads.emplace_back([&arena, &blocks, t]() {
+            for (size_t i = 0; i < per_thread; i++) {
+                uint32_t *p = static_cast<uint32_t*>(arena.allocate(4 * sizeof(uint32_t), alignof(uint32_t)));
+                std::fill(p, p + 4, t);
+                blocks[t].push_back(p);
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    for (uint32_t t = 0; t < blocks.size(); t++) {
+        for (uint32_t *p : blocks[t]) {
+            if (std::count(p, p + 4, t) != 4) {
+                std::cerr << "Arena allocations of different threads overlap." << std::endl;
+                return false;
+            }
+        }
+    }
+    arena.reset();
+    return true;
+}
+
+/** Test inverse results kept as bitsets over the non-stub ASes.
+ *
+ * @return true if successful.
+ */
+bool test_inverse_results(){
+    std::map<std::pair<uint32_t, uint32_t>, ASBitset*> inverse_results;
+    Prefix<> p = Prefix<>("1.1.1.0", "255.255.255.0");
+    uint32_t prefix_id = PrefixTable::getInstance().intern(p);
+    // Spans two words, the second one partially
+    ASBitset *first = new ASBitset(70);
+    ASBitset *second = new ASBitset(70);
+    inverse_results.insert(std::make_pair(std::make_pair(prefix_id, 111u), first));
+    inverse_results.insert(std::make_pair(std::make_pair(prefix_id, 112u), second));
+    if (first->count() != 70 || !first->test(69) || first->test(70)) {
+        return false;
+    }
+
+    AS as = AS(5, false, &inverse_results);
+    as.non_stub_index = 66;
+    Announcement a1 = Announcement(111, p.addr, p.netmask, 199, 222, false);
+    Announcement a2 = Announcement(112, p.addr, p.netmask, 298, 223, false);
+    as.process_announcement(a1, false);
+    if (first->test(66) || first->count() != 69 || second->count() != 70) {
+        return false;
+    }
+    // A better route from another origin moves the AS between the sets
+    as.process_announcement(a2, false);
+    if (!first->test(66) || second->test(66) || second->count() != 69) {
+        return false;
+    }
+
+    // Indices outside the set are ignored
+    AS stub = AS(6, false, &inverse_results);
+    stub.process_announcement(a2, false);
+    std::vector<uint32_t> remaining;
+    second->for_each([&](uint32_t index) { remaining.push_back(index); });
+    if (remaining.size() != 69 || remaining.front() != 0 || remaining.back() != 69 ||
+        std::find(remaining.begin(), remaining.end(), 66) != remaining.end()) {
+        return false;
+    }
+    delete first;
+    delete second;
+    return true;
+}
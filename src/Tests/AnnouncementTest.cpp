@@ -21,7 +21,10 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  ************************************************************************/
 
+#include <sstream>
 #include "Announcements/Announcement.h"
+#include "Announcements/EZAnnouncement.h"
+#include "PathTable.h"
 
 /** Unit tests for Announcements.h
  */
@@ -33,7 +36,7 @@
  */
 bool test_announcement(){
     Announcement ann = Announcement(111, 0x01010101, 0xffffff00, 262, 222, false);
-    if (ann.origin != 111 || ann.prefix.addr != 0x01010101 || ann.prefix.netmask != 0xffffff00 || ann.received_from_asn != 222 || ann.priority != 262 || ann.from_monitor != false)
+    if (ann.origin != 111 || ann.prefix().addr != 0x01010101 || ann.prefix().netmask != 0xffffff00 || ann.received_from_asn != 222 || ann.priority != 262 || ann.from_monitor != false)
         return false;
     return true;
 }
@@ -55,5 +58,37 @@ bool test_ann_os_operator(){
  * @ return True for success 
  */
 bool test_to_csv(){
+    Announcement ann = Announcement(111, 0x01010100, 0xffffff00, 262, 222, 1577836800, true);
+    std::ostringstream os;
+    to_csv(os, ann);
+    if (os.str() != "1.1.1.0/24,111,222,1577836800\n")
+        return false;
+    return true;
+}
+
+/** Tests interning and walking AS paths in the PathTable
+ *
+ * @ return True for success 
+ */
+bool test_path_table(){
+    PathTable &table = PathTable::getInstance();
+    uint32_t a = table.intern(std::vector<uint32_t>({5, 2, 3}));
+    uint32_t b = table.extend(table.extend(table.extend(PathTable::EMPTY_PATH, 5), 2), 3);
+    // Equal paths share a node, a different last hop does not
+    if (a != b || table.extend(table.parent(a), 4) == a)
+        return false;
+    if (table.asn(a) != 3 || table.length(a) != 3 || table.length(PathTable::EMPTY_PATH) != 0)
+        return false;
+    if (!table.contains(a, 5) || table.contains(a, 4) || table.contains(PathTable::EMPTY_PATH, 0))
+        return false;
+    if (table.materialize(a) != std::vector<uint32_t>({5, 2, 3}) || !table.materialize(PathTable::EMPTY_PATH).empty())
+        return false;
+
+    // Copies share the path, EZ paths read back most recent AS first
+    EZAnnouncement ann = EZAnnouncement(5, 0x01010100, 0xffffff00, 222, 0, true);
+    ann.path_id = a;
+    EZAnnouncement copy = ann;
+    if (copy.path_id != a || copy.as_path() != std::vector<uint32_t>({3, 2, 5}))
+        return false;
     return true;
 }
@@ -0,0 +1,184 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "Extrapolators/Extrapolator.h"
+
+/** Microbenchmarks, disabled by default. Run with
+ *      ./bgp-extrapolator --run_test=Benchmark_*
+ */
+
+/** Open a hardware counter for the calling thread.
+ *
+ * @return file descriptor of the counter, or -1 if perf events are unavailable
+ */
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+struct PropagationSample {
+    double seconds;
+    long long l1d_misses;       // -1 if unavailable
+    long long llc_misses;       // -1 if unavailable
+    size_t announcements;
+};
+
+/** Propagate announcements from the origins over the edges, counting cache misses
+ *  during propagate_up and propagate_down only.
+ */
+static PropagationSample run_propagation(bool rank_major_ids, 
+                                         const std::vector<std::pair<uint32_t, uint32_t>> &customer_providers,
+                                         const std::vector<std::pair<uint32_t, uint32_t>> &peers,
+                                         const std::vector<uint32_t> &origins) {
+    Extrapolator e = Extrapolator();
+    e.graph->rank_major_ids = rank_major_ids;
+    for (auto &edge : customer_providers) {
+        e.graph->add_relationship(edge.first, edge.second, AS_REL_PROVIDER);
+        e.graph->add_relationship(edge.second, edge.first, AS_REL_CUSTOMER);
+    }
+    for (auto &edge : peers) {
+        e.graph->add_relationship(edge.first, edge.second, AS_REL_PEER);
+        e.graph->add_relationship(edge.second, edge.first, AS_REL_PEER);
+    }
+    e.graph->decide_ranks();
+
+    for (size_t i = 0; i < origins.size(); i++) {
+        Prefix<> p = Prefix<>(0x0A000000 + (i << 8), 0xFFFFFF00);
+        Announcement ann = Announcement(origins[i], p.addr, p.netmask, 400, origins[i], 0, true);
+        e.graph->ases->find(origins[i])->second->process_announcement(ann, true);
+    }
+
+    int l1d = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | 
+                           (PERF_COUNT_HW_CACHE_OP_READ << 8) | 
+                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    int llc = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    for (int fd : {l1d, llc}) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    e.propagate_up();
+    e.propagate_down();
+    auto finish = std::chrono::high_resolution_clock::now();
+
+    PropagationSample sample;
+    sample.seconds = std::chrono::duration<double>(finish - start).count();
+    long long *counts[2] = {&sample.l1d_misses, &sample.llc_misses};
+    int fds[2] = {l1d, llc};
+    for (int i = 0; i < 2; i++) {
+        *counts[i] = -1;
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fds[i], counts[i], sizeof(long long)) != sizeof(long long))
+                *counts[i] = -1;
+            close(fds[i]);
+        }
+    }
+    sample.announcements = 0;
+    for (auto &as : *e.graph->ases)
+        sample.announcements += as.second->all_anns->size();
+    return sample;
+}
+
+/** Compare propagation over ids in ASN order against rank-major ids.
+ *
+ *  The graph is a synthetic hierarchy where every AS buys transit from one or
+ *  two ASes above it, with ASNs shuffled so ASN order carries no locality.
+ *
+ * @return true if both orders produce the same number of announcements
+ */
+bool benchmark_rank_major_ids() {
+    const uint32_t num_ases = 60000;
+    const uint32_t num_origins = 400;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    std::vector<uint32_t> asns(num_ases);
+    for (uint32_t i = 0; i < num_ases; i++)
+        asns[i] = i + 1;
+    std::shuffle(asns.begin(), asns.end(), gen);
+
+    // Providers are drawn from above, favoring the top of the hierarchy
+    std::vector<std::pair<uint32_t, uint32_t>> customer_providers, peers;
+    for (uint32_t i = 1; i < num_ases; i++) {
+        uint32_t first = i * uniform(gen) * uniform(gen);
+        uint32_t second = i * uniform(gen) * uniform(gen);
+        customer_providers.push_back(std::make_pair(asns[i], asns[first]));
+        if (second != first && uniform(gen) < 0.5)
+            customer_providers.push_back(std::make_pair(asns[i], asns[second]));
+        uint32_t peer = i / 2 + (i - i / 2) * uniform(gen);
+        if (peer != first && peer != second && peer != i && uniform(gen) < 0.2)
+            peers.push_back(std::make_pair(asns[i], asns[peer]));
+    }
+    std::vector<uint32_t> origins;
+    for (uint32_t i = 0; i < num_origins; i++)
+        origins.push_back(asns[(uint64_t) num_ases * uniform(gen)]);
+
+    PropagationSample asn_order = run_propagation(false, customer_providers, peers, origins);
+    PropagationSample rank_major = run_propagation(true, customer_providers, peers, origins);
+
+    auto print = [](const char *name, const PropagationSample &sample) {
+        std::cout << std::setw(12) << name 
+                  << std::setw(12) << std::fixed << std::setprecision(3) << sample.seconds;
+        for (long long count : {sample.l1d_misses, sample.llc_misses}) {
+            if (count < 0)
+                std::cout << std::setw(16) << "n/a";
+            else
+                std::cout << std::setw(16) << count;
+        }
+        std::cout << std::endl;
+    };
+    std::cout << std::setw(12) << "ids" << std::setw(12) << "seconds" 
+              << std::setw(16) << "L1D misses" << std::setw(16) << "LLC misses" << std::endl;
+    print("ASN order", asn_order);
+    print("rank-major", rank_major);
+    if (asn_order.l1d_misses < 0)
+        std::cout << "Hardware counters unavailable, check perf_event_paranoid." << std::endl;
+
+    if (asn_order.announcements != rank_major.announcements) {
+        std::cerr << "Rank-major ids changed the propagation results." << std::endl;
+        return false;
+    }
+    return true;
+}
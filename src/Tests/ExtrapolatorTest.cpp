@@ -24,6 +24,9 @@
 #include <iostream>
 #include <cstdint>
 #include <vector>
+#include <random>
+#include <atomic>
+#include <thread>
 
 #include "Extrapolators/Extrapolator.h"
 
@@ -70,6 +73,68 @@ bool test_find_loop() {
     return true;
 }
 
+/** Test seeding and propagating an IPv6 announcement next to an IPv4 one.
+ *
+ *     3 -- 2      (3 and 2 peer, 1 is a customer of 2)
+ *          |
+ *          1
+ */
+bool test_give_ann_to_as_path_ipv6() {
+    Extrapolator e = Extrapolator();
+    e.graph->add_relationship(2, 1, AS_REL_CUSTOMER);
+    e.graph->add_relationship(1, 2, AS_REL_PROVIDER);
+    e.graph->add_relationship(2, 3, AS_REL_PEER);
+    e.graph->add_relationship(3, 2, AS_REL_PEER);
+    e.graph->decide_ranks();
+
+    std::vector<uint32_t> as_path({2, 3});
+    Prefix<> p4 = Prefix<>("137.99.0.0", "255.255.0.0");
+    Prefix<unsigned __int128> p6 = Prefix<unsigned __int128>("2001:db8::", "ffff:ffff::");
+    e.give_ann_to_as_path(&as_path, p4, 0);
+    e.give_ann_to_as_path(&as_path, p6, 0);
+    e.propagate_up();
+    e.propagate_down();
+
+    // Both families reach the customer and stay apart in its RIB
+    AS *as1 = e.graph->ases->find(1)->second;
+    if (as1->all_anns->size() != 2) {
+        return false;
+    }
+    auto ann6 = as1->all_anns->find(p6);
+    if (ann6 == as1->all_anns->end() || ann6->second.origin != 3 || ann6->second.received_from_asn != 2) {
+        return false;
+    }
+    if (PrefixTable::getInstance().cidr(ann6->second.prefix_id) != "2001:db8::/32") {
+        return false;
+    }
+    return as1->all_anns->find(p4) != as1->all_anns->end();
+}
+
+/** Test parsing AS paths from the bytes of a database field.
+ */
+bool test_parse_path() {
+    Extrapolator e = Extrapolator();
+    std::vector<uint32_t> as_path;
+    e.parse_path("{3356,174,4294967295}", as_path);
+    if (as_path != std::vector<uint32_t>({3356, 174, 4294967295})) {
+        return false;
+    }
+    // The buffer is reused, malformed and out of range ASNs are skipped
+    e.parse_path("{1,2x,4294967296,,3}", as_path);
+    if (as_path != std::vector<uint32_t>({1, 3})) {
+        return false;
+    }
+    e.parse_path("{}", as_path);
+    if (!as_path.empty()) {
+        return false;
+    }
+    // The allocating overload agrees
+    std::vector<uint32_t> *copy = e.parse_path(std::string("{7,8}"));
+    bool same = *copy == std::vector<uint32_t>({7, 8});
+    delete copy;
+    return same;
+}
+
 /** Test seeding the graph with announcements from monitors. 
  *  Horizontal lines are peer relationships, vertical lines are customer-provider
  * 
@@ -403,3 +468,362 @@ bool test_send_all_announcements() {
 
     return true;
 }
+
+/** Build a random hierarchy with peers into an extrapolator and seed it.
+ *  Several origins share each prefix so ties are common.
+ */
+static void build_pull_test_graph(Extrapolator &e, unsigned int seed, bool rank_major_ids) {
+    std::minstd_rand gen(seed);
+    const uint32_t num_ases = 400;
+    e.graph->rank_major_ids = rank_major_ids;
+    for (uint32_t asn = 2; asn <= num_ases; asn++) {
+        // One or two providers with a smaller ASN keep the graph acyclic
+        for (int k = 0; k < 1 + (int) (gen() % 2); k++) {
+            uint32_t provider = 1 + gen() % (asn - 1);
+            e.graph->add_relationship(asn, provider, AS_REL_PROVIDER);
+            e.graph->add_relationship(provider, asn, AS_REL_CUSTOMER);
+        }
+        if (gen() % 3 == 0) {
+            uint32_t peer = 1 + gen() % (asn - 1);
+            if (e.graph->ases->find(asn)->second->providers->count(peer) == 0 &&
+                e.graph->ases->find(peer)->second->providers->count(asn) == 0 &&
+                e.graph->ases->find(asn)->second->customers->count(peer) == 0) {
+                e.graph->add_relationship(asn, peer, AS_REL_PEER);
+                e.graph->add_relationship(peer, asn, AS_REL_PEER);
+            }
+        }
+    }
+    e.graph->decide_ranks();
+    for (uint32_t i = 0; i < 60; i++) {
+        Prefix<> p = Prefix<>(0x0A000000 + ((i % 20) << 8), 0xFFFFFF00);
+        uint32_t origin = 1 + gen() % num_ases;
+        Announcement ann = Announcement(origin, p.addr, p.netmask, 300, origin, 0, true);
+        e.graph->ases->find(origin)->second->process_announcement(ann, e.random_tiebraking);
+    }
+}
+
+/** Test that pulling announcements from neighbors' Loc-RIBs gives the same
+ *  results as sending them, with and without random tiebreaking, on one
+ *  thread and with the ASes of each rank pulling in parallel.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_pull_propagation() {
+    for (int config = 0; config < 8; config++) {
+        bool random_tiebraking = config & 1;
+        bool rank_major_ids = config & 2;
+        bool remove_edges = config & 4;
+        Extrapolator pull = Extrapolator(random_tiebraking, false, true, ANNOUNCEMENTS_TABLE, 
+                                         RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, 
+                                         DEFAULT_ITERATION_SIZE);
+        Extrapolator push = Extrapolator(random_tiebraking, false, true, ANNOUNCEMENTS_TABLE, 
+                                         RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, 
+                                         DEFAULT_ITERATION_SIZE);
+        Extrapolator parallel = Extrapolator(random_tiebraking, false, true, ANNOUNCEMENTS_TABLE, 
+                                             RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, 
+                                             DEFAULT_ITERATION_SIZE);
+        push.pull_propagation = false;
+        parallel.threads = 4;
+        for (Extrapolator *e : {&pull, &parallel, &push}) {
+            build_pull_test_graph(*e, 31 + config, rank_major_ids);
+            // Moves ASes between ranks without renumbering them
+            if (remove_edges) {
+                std::vector<std::pair<uint32_t, uint32_t>> edges;
+                for (uint32_t asn = 40; asn <= 400; asn += 7) {
+                    AS *as = e->graph->ases->find(asn)->second;
+                    if (!as->providers->empty())
+                        edges.push_back(std::make_pair(asn, *as->providers->begin()));
+                }
+                e->graph->remove_relationships(edges);
+            }
+            e->propagate_up();
+            e->propagate_down();
+        }
+
+        for (Extrapolator *pulling : {&pull, &parallel}) {
+            for (auto &as : *push.graph->ases) {
+                AS *pulled = pulling->graph->ases->find(as.first)->second;
+                RIB<Announcement> *expected = as.second->all_anns;
+                RIB<Announcement> *actual = pulled->all_anns;
+                if (expected->size() != actual->size()) {
+                    std::cerr << "Pull propagation stored a different number of announcements at AS " 
+                              << as.first << std::endl;
+                    return false;
+                }
+                for (auto entry = expected->begin(); entry != expected->end(); ++entry) {
+                    auto search = actual->find(entry->first);
+                    if (search == actual->end()) {
+                        std::cerr << "Pull propagation differs at AS " << as.first 
+                                  << " in configuration " << config << std::endl;
+                        return false;
+                    }
+                    // Compare the best route, then the depref route stored next to it
+                    for (bool depref : {false, true}) {
+                        const Announcement *a = depref ? expected->depref(entry) : &entry->second;
+                        const Announcement *b = depref ? actual->depref(search) : &search->second;
+                        if ((a == NULL) != (b == NULL) || (a != NULL &&
+                            (b->origin != a->origin ||
+                             b->priority != a->priority ||
+                             b->received_from_asn != a->received_from_asn))) {
+                            std::cerr << "Pull propagation differs at AS " << as.first 
+                                      << " in configuration " << config << std::endl;
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/** Test that frontier-driven propagation gives the same results as visiting
+ *  every AS, on one thread and in parallel, for a dense block and for a 
+ *  block seeded at a single AS after the graph was cleared.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_sparse_propagation() {
+    for (int config = 0; config < 8; config++) {
+        bool random_tiebraking = config & 1;
+        bool remove_edges = config & 2;
+        uint32_t threads = (config & 4) ? 4 : 1;
+        Extrapolator dense = Extrapolator(random_tiebraking, false, true, ANNOUNCEMENTS_TABLE, 
+                                          RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, 
+                                          DEFAULT_ITERATION_SIZE);
+        Extrapolator sparse = Extrapolator(random_tiebraking, false, true, ANNOUNCEMENTS_TABLE, 
+                                           RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, 
+                                           DEFAULT_ITERATION_SIZE);
+        sparse.sparse_propagation = true;
+        sparse.threads = threads;
+        for (Extrapolator *e : {&dense, &sparse}) {
+            build_pull_test_graph(*e, 53 + config, true);
+            if (remove_edges) {
+                std::vector<std::pair<uint32_t, uint32_t>> edges;
+                for (uint32_t asn = 40; asn <= 400; asn += 7) {
+                    AS *as = e->graph->ases->find(asn)->second;
+                    if (!as->providers->empty())
+                        edges.push_back(std::make_pair(asn, *as->providers->begin()));
+                }
+                e->graph->remove_relationships(edges);
+            }
+        }
+        // The test graph seeds its announcements directly
+        for (auto &as : *sparse.graph->ases) {
+            if (!as.second->all_anns->empty())
+                sparse.touch(as.second);
+        }
+
+        for (int round = 0; round < 2; round++) {
+            for (Extrapolator *e : {&dense, &sparse}) {
+                e->propagate_up();
+                e->propagate_down();
+            }
+            for (auto &as : *dense.graph->ases) {
+                RIB<Announcement> *expected = as.second->all_anns;
+                RIB<Announcement> *actual = sparse.graph->ases->find(as.first)->second->all_anns;
+                bool same = expected->size() == actual->size();
+                for (auto entry = expected->begin(); same && entry != expected->end(); ++entry) {
+                    auto search = actual->find(entry->first);
+                    same = search != actual->end() &&
+                           search->second.origin == entry->second.origin &&
+                           search->second.priority == entry->second.priority &&
+                           search->second.received_from_asn == entry->second.received_from_asn;
+                }
+                if (!same) {
+                    std::cerr << "Sparse propagation differs at AS " << as.first << " in configuration " 
+                              << config << ", round " << round << std::endl;
+                    return false;
+                }
+            }
+
+            // Then a block reaching only what lies around a single origin
+            sparse.clear_block();
+            for (auto &as : *sparse.graph->ases) {
+                if (!as.second->all_anns->empty()) {
+                    std::cerr << "Sparse propagation left announcements at AS " << as.first << std::endl;
+                    return false;
+                }
+            }
+            dense.clear_block();
+            std::vector<uint32_t> path = {350};
+            for (Extrapolator *e : {&dense, &sparse})
+                e->give_ann_to_as_path(&path, Prefix<>("137.99.0.0", "255.255.0.0"), 0);
+        }
+    }
+    return true;
+}
+
+/** Test that the thread pool runs every index of a loop exactly once, both
+ *  with even chunks and with chunks cut by a very uneven cost, and keeps 
+ *  the idle time of every thread.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_thread_pool() {
+    ThreadPool pool(4);
+    const size_t n = 5000;
+    std::vector<std::atomic<uint32_t>> visits(n);
+    // A few heavy indices, like tier-1 ASes in a rank
+    std::vector<uint64_t> cost(n, 1);
+    for (size_t i = 0; i < n; i += 1000)
+        cost[i] = 100000;
+    for (int weighted = 0; weighted < 2; weighted++) {
+        for (auto &v : visits)
+            v = 0;
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                visits[i]++;
+        };
+        if (weighted)
+            pool.parallel_for(n, cost, body);
+        else
+            pool.parallel_for(n, body, 7);
+        for (size_t i = 0; i < n; i++) {
+            if (visits[i] != 1) {
+                std::cerr << "Thread pool ran index " << i << " " << visits[i] << " times" << std::endl;
+                return false;
+            }
+        }
+    }
+    std::vector<double> idle = pool.idle_seconds();
+    if (idle.size() != pool.size()) {
+        std::cerr << "Thread pool reported idle time for " << idle.size() << " threads" << std::endl;
+        return false;
+    }
+    for (double seconds : idle) {
+        if (seconds < 0) {
+            std::cerr << "Thread pool reported negative idle time" << std::endl;
+            return false;
+        }
+    }
+    pool.reset_idle();
+    for (double seconds : pool.idle_seconds()) {
+        if (seconds != 0) {
+            std::cerr << "Thread pool idle time was not reset" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Test that a bounded queue hands items over in order, makes the producer
+ *  wait while it is full, and ends once closed and drained.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_bounded_queue() {
+    BoundedQueue<int> queue(2);
+    std::thread producer([&]() {
+        for (int i = 0; i < 1000; i++)
+            queue.push(i);
+        queue.close();
+    });
+    int item, expected = 0;
+    while (queue.pop(item)) {
+        if (item != expected++) {
+            std::cerr << "Bounded queue returned " << item << " out of order" << std::endl;
+            producer.join();
+            return false;
+        }
+    }
+    producer.join();
+    if (expected != 1000) {
+        std::cerr << "Bounded queue returned " << expected << " items" << std::endl;
+        return false;
+    }
+
+    // A full queue holds the producer back until an item is taken
+    BoundedQueue<int> full(1);
+    full.push(1);
+    std::atomic<bool> pushed(false);
+    std::thread blocked([&]() {
+        full.push(2);
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    bool early = pushed;
+    full.pop(item);
+    blocked.join();
+    if (early || !pushed) {
+        std::cerr << "Bounded queue did not hold back the producer" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Test that block workers share the topology of the graph they were made
+ *  from but keep their own announcements, so several can propagate at once.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_block_workers() {
+    Extrapolator e = Extrapolator(false, false, true, ANNOUNCEMENTS_TABLE, 
+                                  RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, 
+                                  DEFAULT_ITERATION_SIZE);
+    build_pull_test_graph(e, 17, true);
+    std::vector<Extrapolator*> workers;
+    for (int i = 0; i < 2; i++) {
+        Extrapolator *worker = dynamic_cast<Extrapolator*>(e.create_worker());
+        if (worker == NULL || worker->graph->ases_by_rank != e.graph->ases_by_rank ||
+            worker->graph->customer_csr != e.graph->customer_csr ||
+            worker->graph->ases->size() != e.graph->ases->size()) {
+            std::cerr << "Block worker does not share the topology" << std::endl;
+            return false;
+        }
+        // Seed the worker with the same announcements
+        for (auto &as : *e.graph->ases) {
+            AS *counterpart = worker->graph->ases->find(as.first)->second;
+            if (counterpart->id != as.second->id || counterpart->providers != as.second->providers) {
+                std::cerr << "Block worker AS " << as.first << " differs" << std::endl;
+                return false;
+            }
+            for (auto &entry : *as.second->all_anns) {
+                Announcement ann = entry.second;
+                counterpart->process_announcement(ann, false);
+            }
+        }
+        workers.push_back(worker);
+    }
+
+    // Workers propagate at the same time, the graph they came from afterwards
+    std::vector<std::thread> running;
+    for (Extrapolator *worker : workers) {
+        running.push_back(std::thread([worker]() {
+            worker->propagate_up();
+            worker->propagate_down();
+        }));
+    }
+    for (auto &t : running)
+        t.join();
+    e.propagate_up();
+    e.propagate_down();
+
+    bool same = true;
+    for (Extrapolator *worker : workers) {
+        for (auto &as : *e.graph->ases) {
+            RIB<Announcement> *expected = as.second->all_anns;
+            RIB<Announcement> *actual = worker->graph->ases->find(as.first)->second->all_anns;
+            if (expected == actual || expected->size() != actual->size()) {
+                same = false;
+                break;
+            }
+            for (auto entry = expected->begin(); entry != expected->end(); ++entry) {
+                auto search = actual->find(entry->first);
+                if (search == actual->end() ||
+                    search->second.origin != entry->second.origin ||
+                    search->second.priority != entry->second.priority ||
+                    search->second.received_from_asn != entry->second.received_from_asn) {
+                    same = false;
+                    break;
+                }
+            }
+        }
+    }
+    if (!same)
+        std::cerr << "Block worker propagated different announcements" << std::endl;
+    // Workers go first, the topology belongs to e
+    for (Extrapolator *worker : workers)
+        delete worker;
+    return same;
+}
@@ -22,6 +22,7 @@
  ************************************************************************/
 
 #include "Prefix.h"
+#include "PrefixTable.h"
 
 /** Unit tests for Prefix.h
  */
@@ -61,6 +62,19 @@ bool test_prefix(){
     if (p5.addr != 0x0 || p5.netmask != 0xffffff00)
         return false;
 
+    // Check trailing garbage
+    Prefix<> p6 = Prefix<>("1.1.1.0x", "255.255.255.0");
+    if (p6.addr != 0x0 || p6.netmask != 0xffffff00)
+        return false;
+
+    // Check octets longer than three digits
+    Prefix<> p7 = Prefix<>("0001.2.3.4", "255.255.255.0");
+    if (p7.addr != 0x0 || p7.netmask != 0xffffff00)
+        return false;
+    Prefix<> p8 = Prefix<>("1.2.3.0255", "255.255.255.0");
+    if (p8.addr != 0x0 || p8.netmask != 0xffffff00)
+        return false;
+
    return true;
 }
 
@@ -134,4 +148,70 @@ bool test_prefix_contained_in_or_equal_to_operator(){
     if (a.contained_in_or_equal_to(b))
         return false;
     return true;
-}
\ No newline at end of file
+}
+/** Tests interning prefixes in the PrefixTable.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_prefix_table(){
+    PrefixTable &table = PrefixTable::getInstance();
+    Prefix<> a = Prefix<>("10.20.0.0", "255.255.0.0");
+    Prefix<> b = Prefix<>("10.20.0.0", "255.255.255.0");
+    if (table.lookup(a) != PrefixTable::NO_PREFIX)
+        return false;
+    uint32_t id_a = table.intern(a);
+    uint32_t id_b = table.intern(b);
+    // Same prefix gets the same id, a different netmask does not
+    if (id_a == id_b || table.intern(a) != id_a || table.lookup(b) != id_b)
+        return false;
+    if (table.prefix(id_a) != a || table.prefix(id_b) != b)
+        return false;
+    if (table.cidr(id_a) != "10.20.0.0/16" || table.cidr(id_b) != "10.20.0.0/24")
+        return false;
+    if (table.size() <= id_b)
+        return false;
+
+    // IPv6 prefixes share the id space
+    Prefix<unsigned __int128> c = Prefix<unsigned __int128>("2001:db8::", "ffff:ffff::");
+    uint32_t id_c = table.intern(c);
+    if (id_c == id_a || id_c == id_b || table.intern(c) != id_c || table.lookup(c) != id_c)
+        return false;
+    if (!table.is_ipv6(id_c) || table.is_ipv6(id_a) || table.prefix6(id_c) != c || table.cidr(id_c) != "2001:db8::/32")
+        return false;
+    return true;
+}
+
+/** Tests parsing and formatting IPv6 prefixes.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_prefix_ipv6(){
+    Prefix<unsigned __int128> p = Prefix<unsigned __int128>("2001:db8::", "ffff:ffff::");
+    unsigned __int128 addr = static_cast<unsigned __int128>(0x20010DB800000000ULL) << 64;
+    unsigned __int128 mask = static_cast<unsigned __int128>(0xFFFFFFFF00000000ULL) << 64;
+    if (p.addr != addr || p.netmask != mask || p.length() != 32)
+        return false;
+    if (p.to_cidr() != "2001:db8::/32")
+        return false;
+
+    // Canonical form compresses the longest zero run and drops leading zeros
+    Prefix<unsigned __int128> q = Prefix<unsigned __int128>("2001:0DB8:0:0:1:0:0:1", "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff");
+    if (q.to_cidr() != "2001:db8::1:0:0:1/128")
+        return false;
+    Prefix<unsigned __int128> mapped = Prefix<unsigned __int128>("::ffff:192.0.2.1", "::");
+    if (mapped.to_cidr() != "::ffff:c000:201/0")
+        return false;
+
+    // Malformed input defaults to ::
+    const char *malformed[] = {":", "1:::2", "1:2:3:4:5:6:7:8:9", "12345::", "1::2::3", "1:2:3:4:5:6:7", "1:", "g::"};
+    for (const char *str : malformed) {
+        if (Prefix<unsigned __int128>(str, "::").addr != 0)
+            return false;
+    }
+
+    // Splitting a block keeps the halves apart
+    Prefix<unsigned __int128> half = Prefix<unsigned __int128>("8000::", "8000::");
+    if (!half.contained_in_or_equal_to(Prefix<unsigned __int128>("::", "::")) || half < p || half.to_cidr() != "8000::/1")
+        return false;
+    return true;
+}
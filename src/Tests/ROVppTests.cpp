@@ -785,17 +785,16 @@ bool test_rovpp_receive_announcements(){
     vect.push_back(ann);
     // this function should make a copy of the announcement
     // if it does not, it is incorrect
-    Prefix<> old_prefix = ann.prefix;
-    ann.prefix.addr = 0x321C9F00;
-    ann.prefix.netmask = 0xFFFFFF00;
-    Prefix<> new_prefix = ann.prefix;
+    Prefix<> old_prefix = ann.prefix();
+    ann.prefix_id = PrefixTable::getInstance().intern(Prefix<>(0x321C9F00, 0xFFFFFF00));
+    Prefix<> new_prefix = ann.prefix();
     vect.push_back(ann);
     ROVppAS as = ROVppAS(1);
     as.receive_announcements(vect);
     if (as.ribs_in->size() != 2) { return false; }
     // order really doesn't matter here
     for (Announcement a : *as.ribs_in) {
-        if (a.prefix != old_prefix && a.prefix != new_prefix) {
+        if (a.prefix() != old_prefix && a.prefix() != new_prefix) {
             return false;
         }
     }
@@ -810,8 +809,7 @@ bool test_rovpp_rov_receive_announcements(){
     ROVppAnnouncement ann = ROVppAnnouncement(13796, 0x89630000, 0xFFFF0000, 22742);
     std::vector<ROVppAnnouncement> vect = std::vector<ROVppAnnouncement>();
     vect.push_back(ann);
-    ann.prefix.addr = 0x321C9F00;
-    ann.prefix.netmask = 0xFFFFFF00;
+    ann.prefix_id = PrefixTable::getInstance().intern(Prefix<>(0x321C9F00, 0xFFFFFF00));
     ann.origin = 666;
     vect.push_back(ann);
     ROVppAS as = ROVppAS(1);
@@ -836,13 +834,12 @@ bool test_rovpp_process_announcement(){
     // if it does not, it is incorrect
     ROVppAS as = ROVppAS(1);
     as.process_announcement(ann);
-    Prefix<> old_prefix = ann.prefix;
-    ann.prefix.addr = 0x321C9F00;
-    ann.prefix.netmask = 0xFFFFFF00;
-    Prefix<> new_prefix = ann.prefix;
+    Prefix<> old_prefix = ann.prefix();
+    ann.prefix_id = PrefixTable::getInstance().intern(Prefix<>(0x321C9F00, 0xFFFFFF00));
+    Prefix<> new_prefix = ann.prefix();
     as.process_announcement(ann);
-    if (new_prefix != as.loc_rib->find(ann.prefix)->second.prefix ||
-        old_prefix != as.loc_rib->find(old_prefix)->second.prefix) {
+    if (new_prefix != as.loc_rib->find(ann.prefix())->second.prefix() ||
+        old_prefix != as.loc_rib->find(old_prefix)->second.prefix()) {
         return false;
     }
 
@@ -880,9 +877,9 @@ bool test_rovpp_process_announcement(){
  */
 bool test_rovpp_process_announcements(){
     ROVppAnnouncement ann1 = ROVppAnnouncement(13796, 0x89630000, 0xFFFF0000, 22742);
-    Prefix<> ann1_prefix = ann1.prefix;
+    Prefix<> ann1_prefix = ann1.prefix();
     ROVppAnnouncement ann2 = ROVppAnnouncement(13796, 0x321C9F00, 0xFFFFFF00, 22742);
-    Prefix<> ann2_prefix = ann2.prefix;
+    Prefix<> ann2_prefix = ann2.prefix();
     ROVppAS as = ROVppAS(1);
     // build a vector of announcements
     std::vector<ROVppAnnouncement> vect = std::vector<ROVppAnnouncement>();
@@ -990,8 +987,8 @@ bool test_rovpp_announcement(){
     std::vector<uint32_t> x;
     ROVppAnnouncement ann = ROVppAnnouncement(111, 0x01010101, 0xffffff00, 0, 222, 100, 1, x);
     if (ann.origin != 111 
-        || ann.prefix.addr != 0x01010101 
-        || ann.prefix.netmask != 0xffffff00 
+        || ann.prefix().addr != 0x01010101 
+        || ann.prefix().netmask != 0xffffff00 
         || ann.received_from_asn != 222 
         || ann.priority != 0 
         || ann.from_monitor != false 
@@ -1002,8 +999,8 @@ bool test_rovpp_announcement(){
     
     ann = ROVppAnnouncement(111, 0x01010101, 0xffffff00, 262, 222, 100, 1, x, true);
     if (ann.origin != 111 
-        || ann.prefix.addr != 0x01010101 
-        || ann.prefix.netmask != 0xffffff00 
+        || ann.prefix().addr != 0x01010101 
+        || ann.prefix().netmask != 0xffffff00 
         || ann.received_from_asn != 222 
         || ann.priority != 262 
         || ann.from_monitor != true 
@@ -1351,9 +1348,9 @@ bool test_rovpp_full_path() {
     e.propagate_down();
 
     // Check if seeded path is present
-    if (e.graph->ases->find(5)->second->loc_rib->find(p)->second.as_path.size() != 1) {
+    if (e.graph->ases->find(5)->second->loc_rib->find(p)->second.as_path().size() != 1) {
         std::cerr << "Failed seeding full AS path." << '\n';
-        for (auto const& i: e.graph->ases->find(5)->second->loc_rib->find(p)->second.as_path) {
+        for (auto const& i: e.graph->ases->find(5)->second->loc_rib->find(p)->second.as_path()) {
             std::cerr << i;
         }
         std::cerr << '\n';
@@ -1369,19 +1366,19 @@ bool test_rovpp_full_path() {
     std::vector<uint32_t> path_6{ 5 };
     std::vector<uint32_t> path_7{ 5, 2, 3 };
 
-    if (e.graph->ases->find(1)->second->loc_rib->find(p)->second.as_path.size() != 2 || 
-        e.graph->ases->find(2)->second->loc_rib->find(p)->second.as_path.size() != 1 ||
-        e.graph->ases->find(3)->second->loc_rib->find(p)->second.as_path.size() != 2 ||
-        e.graph->ases->find(4)->second->loc_rib->find(p)->second.as_path.size() != 2 ||
-        e.graph->ases->find(6)->second->loc_rib->find(p)->second.as_path.size() != 1 ||
-        e.graph->ases->find(7)->second->loc_rib->find(p)->second.as_path.size() != 3) {
+    if (e.graph->ases->find(1)->second->loc_rib->find(p)->second.as_path().size() != 2 || 
+        e.graph->ases->find(2)->second->loc_rib->find(p)->second.as_path().size() != 1 ||
+        e.graph->ases->find(3)->second->loc_rib->find(p)->second.as_path().size() != 2 ||
+        e.graph->ases->find(4)->second->loc_rib->find(p)->second.as_path().size() != 2 ||
+        e.graph->ases->find(6)->second->loc_rib->find(p)->second.as_path().size() != 1 ||
+        e.graph->ases->find(7)->second->loc_rib->find(p)->second.as_path().size() != 3) {
         std::cerr << "Failed propagating full AS path." << '\n';
         return false;
     }
     
-    if (e.graph->ases->find(1)->second->loc_rib->find(p)->second.as_path != path_1) { 
+    if (e.graph->ases->find(1)->second->loc_rib->find(p)->second.as_path() != path_1) { 
         std::cerr << "Failed propagating full AS path." << '\n';
-        for (auto const& i: e.graph->ases->find(1)->second->loc_rib->find(p)->second.as_path) {
+        for (auto const& i: e.graph->ases->find(1)->second->loc_rib->find(p)->second.as_path()) {
             std::cerr << i;
         }
         std::cerr << '\n';
@@ -1391,9 +1388,9 @@ bool test_rovpp_full_path() {
         std::cerr << '\n';
         return false;
     }
-    if (e.graph->ases->find(2)->second->loc_rib->find(p)->second.as_path != path_2) { 
+    if (e.graph->ases->find(2)->second->loc_rib->find(p)->second.as_path() != path_2) { 
         std::cerr << "Failed propagating full AS path." << '\n';
-        for (auto const& i: e.graph->ases->find(2)->second->loc_rib->find(p)->second.as_path) {
+        for (auto const& i: e.graph->ases->find(2)->second->loc_rib->find(p)->second.as_path()) {
             std::cerr << i;
         }
         std::cerr << '\n';
@@ -1403,9 +1400,9 @@ bool test_rovpp_full_path() {
         std::cerr << '\n';
         return false;
     }
-    if (e.graph->ases->find(3)->second->loc_rib->find(p)->second.as_path != path_3) { 
+    if (e.graph->ases->find(3)->second->loc_rib->find(p)->second.as_path() != path_3) { 
         std::cerr << "Failed propagating full AS path." << '\n';
-        for (auto const& i: e.graph->ases->find(3)->second->loc_rib->find(p)->second.as_path) {
+        for (auto const& i: e.graph->ases->find(3)->second->loc_rib->find(p)->second.as_path()) {
             std::cerr << i;
         }
         std::cerr << '\n';
@@ -1415,9 +1412,9 @@ bool test_rovpp_full_path() {
         std::cerr << '\n';
         return false;
     }
-    if (e.graph->ases->find(4)->second->loc_rib->find(p)->second.as_path != path_4) { 
+    if (e.graph->ases->find(4)->second->loc_rib->find(p)->second.as_path() != path_4) { 
         std::cerr << "Failed propagating full AS path." << '\n';
-        for (auto const& i: e.graph->ases->find(4)->second->loc_rib->find(p)->second.as_path) {
+        for (auto const& i: e.graph->ases->find(4)->second->loc_rib->find(p)->second.as_path()) {
             std::cerr << i;
         }
         std::cerr << '\n';
@@ -1427,9 +1424,9 @@ bool test_rovpp_full_path() {
         std::cerr << '\n';
         return false;
     }
-    if (e.graph->ases->find(6)->second->loc_rib->find(p)->second.as_path != path_6) { 
+    if (e.graph->ases->find(6)->second->loc_rib->find(p)->second.as_path() != path_6) { 
         std::cerr << "Failed propagating full AS path." << '\n';
-        for (auto const& i: e.graph->ases->find(6)->second->loc_rib->find(p)->second.as_path) {
+        for (auto const& i: e.graph->ases->find(6)->second->loc_rib->find(p)->second.as_path()) {
             std::cerr << i;
         }
         std::cerr << '\n';
@@ -1439,9 +1436,9 @@ bool test_rovpp_full_path() {
         std::cerr << '\n';
         return false;
     }
-    if (e.graph->ases->find(7)->second->loc_rib->find(p)->second.as_path != path_7) { 
+    if (e.graph->ases->find(7)->second->loc_rib->find(p)->second.as_path() != path_7) { 
         std::cerr << "Failed propagating full AS path." << '\n';
-        for (auto const& i: e.graph->ases->find(7)->second->loc_rib->find(p)->second.as_path) {
+        for (auto const& i: e.graph->ases->find(7)->second->loc_rib->find(p)->second.as_path()) {
             std::cerr << i;
         }
         std::cerr << '\n';
@@ -1,3 +1,121 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SQLQueriers/BinaryCopyDecoder.h"
+
 /** Units tests for the SQLQuerier.cpp
  */
 
+/** Append a big endian integer of the given width to a COPY message.
+ */
+static void append_be(std::string &msg, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--)
+        msg.push_back((char) ((value >> (8 * i)) & 0xFF));
+}
+
+/** Test decoding a binary COPY stream of integer columns.
+ *  Rows mix integer and bigint fields, and a row with a NULL is skipped.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_binary_copy_decoder(){
+    // Header with the first row: signature, flags, empty extension
+    std::string first("PGCOPY\n\377\r\n\0", 11);
+    append_be(first, 0, 4);
+    append_be(first, 0, 4);
+    append_be(first, 2, 2);
+    append_be(first, 4, 4);
+    append_be(first, 13335, 4);
+    append_be(first, 8, 4);
+    append_be(first, 4200000000u, 8);
+    // Row with a NULL field
+    std::string null_row;
+    append_be(null_row, 2, 2);
+    append_be(null_row, 4, 4);
+    append_be(null_row, 7, 4);
+    append_be(null_row, 0xFFFFFFFF, 4);
+    // Last row and trailer
+    std::string last;
+    append_be(last, 2, 2);
+    append_be(last, 4, 4);
+    append_be(last, 1, 4);
+    append_be(last, 4, 4);
+    append_be(last, 2, 4);
+    std::string trailer;
+    append_be(trailer, 0xFFFF, 2);
+
+    BinaryCopyDecoder decoder(2);
+    std::vector<uint32_t> values;
+    for (std::string *msg : {&first, &null_row, &last}) {
+        if (!decoder.decode(msg->data(), msg->size(), values) || decoder.finished()) {
+            std::cerr << "Failed to decode binary COPY row." << std::endl;
+            return false;
+        }
+    }
+    if (!decoder.decode(trailer.data(), trailer.size(), values) || !decoder.finished()) {
+        std::cerr << "Failed to decode binary COPY trailer." << std::endl;
+        return false;
+    }
+    if (values != std::vector<uint32_t>({13335, 4200000000u, 1, 2})) {
+        std::cerr << "Wrong values decoded from binary COPY." << std::endl;
+        return false;
+    }
+
+    // Rows with the wrong number of columns or a text header are rejected
+    BinaryCopyDecoder wide_decoder(3);
+    values.clear();
+    if (wide_decoder.decode(first.data(), first.size(), values)) {
+        std::cerr << "Decoded a row with the wrong number of columns." << std::endl;
+        return false;
+    }
+    BinaryCopyDecoder text_decoder(2);
+    std::string text("1\t2\n");
+    if (text_decoder.decode(text.data(), text.size(), values)) {
+        std::cerr << "Decoded a text COPY stream as binary." << std::endl;
+        return false;
+    }
+
+    // Values outside the 32-bit ASN range are rejected rather than truncated or sign-extended
+    std::vector<std::pair<int, uint64_t>> out_of_range = {{8, (uint64_t) UINT32_MAX + 1}, {8, (uint64_t) -1},
+                                                          {4, 0x80000000u}, {4, 0xFFFFFFFFu}, {2, 0xFFFF}};
+    for (auto &field : out_of_range) {
+        std::string wide("PGCOPY\n\377\r\n\0", 11);
+        append_be(wide, 0, 4);
+        append_be(wide, 0, 4);
+        append_be(wide, 2, 2);
+        append_be(wide, 4, 4);
+        append_be(wide, 1, 4);
+        append_be(wide, field.first, 4);
+        append_be(wide, field.second, field.first);
+        BinaryCopyDecoder range_decoder(2);
+        if (range_decoder.decode(wide.data(), wide.size(), values)) {
+            std::cerr << "Decoded a " << 8 * field.first << "-bit value outside the ASN range." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -46,12 +46,29 @@ BOOST_AUTO_TEST_CASE( Prefix_equivalence_operator ) {
 BOOST_AUTO_TEST_CASE( Prefix_contained_in_or_equal_to_operator ) {
         BOOST_CHECK( test_prefix_contained_in_or_equal_to_operator() );
 }
+BOOST_AUTO_TEST_CASE( PrefixTable_intern ) {
+        BOOST_CHECK( test_prefix_table() );
+}
+BOOST_AUTO_TEST_CASE( Prefix_ipv6 ) {
+        BOOST_CHECK( test_prefix_ipv6() );
+}
 
 
 // Announcement.h
 BOOST_AUTO_TEST_CASE( Announcement_constructor ) {
         BOOST_CHECK( test_announcement() );
 }
+BOOST_AUTO_TEST_CASE( Announcement_to_csv ) {
+        BOOST_CHECK( test_to_csv() );
+}
+BOOST_AUTO_TEST_CASE( Announcement_path_table ) {
+        BOOST_CHECK( test_path_table() );
+}
+
+// SQLQuerier.cpp
+BOOST_AUTO_TEST_CASE( SQLQuerier_binary_copy_decoder ) {
+        BOOST_CHECK( test_binary_copy_decoder() );
+}
 
 // AS.cpp
 BOOST_AUTO_TEST_CASE( AS_get_random ) {
@@ -78,6 +95,15 @@ BOOST_AUTO_TEST_CASE( AS_already_received ) {
 BOOST_AUTO_TEST_CASE( AS_clear_announcements ) {
         BOOST_CHECK( test_clear_announcements() );
 }
+BOOST_AUTO_TEST_CASE( AS_rib ) {
+        BOOST_CHECK( test_rib() );
+}
+BOOST_AUTO_TEST_CASE( AS_arena ) {
+        BOOST_CHECK( test_arena() );
+}
+BOOST_AUTO_TEST_CASE( AS_inverse_results ) {
+        BOOST_CHECK( test_inverse_results() );
+}
 
 // ASGraph.cpp
 BOOST_AUTO_TEST_CASE( ASGraph_add_relationship ) {
@@ -89,12 +115,27 @@ BOOST_AUTO_TEST_CASE( ASGraph_translate_asn ) {
 BOOST_AUTO_TEST_CASE( ASGraph_decide_ranks ) {
         BOOST_CHECK( test_decide_ranks() );
 }
+BOOST_AUTO_TEST_CASE( ASGraph_build_adjacency ) {
+        BOOST_CHECK( test_build_adjacency() );
+}
 BOOST_AUTO_TEST_CASE( ASGraph_tarjan_test ) {
         BOOST_CHECK( test_tarjan() );
 }
+BOOST_AUTO_TEST_CASE( ASGraph_parallel_scc_test ) {
+        BOOST_CHECK( test_parallel_scc() );
+}
 BOOST_AUTO_TEST_CASE( ASGraph_combine_components_test ) {
         BOOST_CHECK( test_combine_components() );
 }
+BOOST_AUTO_TEST_CASE( ASGraph_topology_snapshot_test ) {
+        BOOST_CHECK( test_topology_snapshot() );
+}
+BOOST_AUTO_TEST_CASE( ASGraph_create_graph_from_file_test ) {
+        BOOST_CHECK( test_create_graph_from_file() );
+}
+BOOST_AUTO_TEST_CASE( ASGraph_remove_relationships_test ) {
+        BOOST_CHECK( test_remove_relationships() );
+}
 
 // Extrapolator.cpp
 BOOST_AUTO_TEST_CASE( Extrapolator_constructor ) {
@@ -115,6 +156,27 @@ BOOST_AUTO_TEST_CASE( Extrapolator_propagate_down2 ) {
 BOOST_AUTO_TEST_CASE( Extrapolator_send_all_announcements ) {
         BOOST_CHECK( test_send_all_announcements() );
 }
+BOOST_AUTO_TEST_CASE( Extrapolator_pull_propagation ) {
+        BOOST_CHECK( test_pull_propagation() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_sparse_propagation ) {
+        BOOST_CHECK( test_sparse_propagation() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_thread_pool ) {
+        BOOST_CHECK( test_thread_pool() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_bounded_queue ) {
+        BOOST_CHECK( test_bounded_queue() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_block_workers ) {
+        BOOST_CHECK( test_block_workers() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_parse_path ) {
+        BOOST_CHECK( test_parse_path() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_give_ann_to_as_path_ipv6 ) {
+        BOOST_CHECK( test_give_ann_to_as_path_ipv6() );
+}
 
 // ROVpp
 BOOST_AUTO_TEST_CASE( Announcement_eqality_operator ) {
@@ -203,6 +265,12 @@ BOOST_AUTO_TEST_CASE( EZBGPsec_test_path_propagation ) {
         BOOST_CHECK( ezbgpsec_test_path_propagation() );
 }
 
+// Benchmarks, run with --run_test=Benchmark_*
+
+BOOST_AUTO_TEST_CASE( Benchmark_rank_major_ids, * boost::unit_test::disabled() ) {
+        BOOST_CHECK( benchmark_rank_major_ids() );
+}
+
 #endif // RUN_TESTS
 
 
@@ -0,0 +1,178 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+// Chunks dealt to each thread by a weighted loop, enough to steal from
+#define CHUNKS_PER_THREAD 8
+
+ThreadPool::ThreadPool(uint32_t num_threads) : job(NULL), running(0), generation(0), stopping(false) {
+    uint32_t n = std::max<uint32_t>(num_threads, 1);
+    for (uint32_t i = 0; i < n; i++)
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    out_of_work.resize(n);
+    idle.assign(n, 0);
+    for (uint32_t i = 1; i < n; i++)
+        workers.push_back(std::thread(&ThreadPool::work, this, i));
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t : workers)
+        t.join();
+}
+
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t, size_t)> &body, size_t grain) {
+    grain = std::max<size_t>(grain, 1);
+    // Not worth waking anyone for a single chunk
+    if (workers.empty() || n <= grain) {
+        if (n > 0)
+            body(0, n);
+        return;
+    }
+
+    std::vector<Chunk> chunks;
+    for (size_t begin = 0; begin < n; begin += grain)
+        chunks.push_back(Chunk(begin, std::min(begin + grain, n)));
+    run(chunks, body);
+}
+
+void ThreadPool::parallel_for(size_t n, const std::vector<uint64_t> &cost, const std::function<void(size_t, size_t)> &body) {
+    if (workers.empty() || n <= 1) {
+        if (n > 0)
+            body(0, n);
+        return;
+    }
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++)
+        total += cost[i];
+    uint64_t share = std::max<uint64_t>(total / (size() * CHUNKS_PER_THREAD), 1);
+
+    // Close a chunk once it reaches its share, a heavy index ends up alone
+    std::vector<Chunk> chunks;
+    size_t begin = 0;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i > begin && sum + cost[i] > share) {
+            chunks.push_back(Chunk(begin, i));
+            begin = i;
+            sum = 0;
+        }
+        sum += cost[i];
+    }
+    chunks.push_back(Chunk(begin, n));
+    if (chunks.size() == 1) {
+        body(0, n);
+        return;
+    }
+    run(chunks, body);
+}
+
+std::vector<double> ThreadPool::idle_seconds() const {
+    return idle;
+}
+
+void ThreadPool::reset_idle() {
+    std::fill(idle.begin(), idle.end(), 0);
+}
+
+void ThreadPool::run(std::vector<Chunk> &chunks, const std::function<void(size_t, size_t)> &body) {
+    // Neighboring chunks go to the same thread
+    size_t threads = queues.size();
+    for (size_t t = 0; t < threads; t++) {
+        std::lock_guard<std::mutex> guard(queues[t]->lock);
+        queues[t]->chunks.assign(chunks.begin() + chunks.size() * t / threads,
+                                 chunks.begin() + chunks.size() * (t + 1) / threads);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        job = &body;
+        running = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+    run_chunks(0);
+
+    std::unique_lock<std::mutex> guard(lock);
+    finished.wait(guard, [&]() { return running == 0; });
+    job = NULL;
+    auto end = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; t++)
+        idle[t] += std::chrono::duration<double>(end - out_of_work[t]).count();
+}
+
+void ThreadPool::work(uint32_t self) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&]() { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+        run_chunks(self);
+        std::lock_guard<std::mutex> guard(lock);
+        if (--running == 0)
+            finished.notify_one();
+    }
+}
+
+void ThreadPool::run_chunks(uint32_t self) {
+    Chunk chunk;
+    while (take(self, chunk))
+        (*job)(chunk.first, chunk.second);
+    // Read by the caller once every worker checked out under the lock
+    out_of_work[self] = std::chrono::steady_clock::now();
+}
+
+bool ThreadPool::take(uint32_t self, Chunk &chunk) {
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+    // No chunks are added during a loop, so empty queues stay empty
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue &victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}